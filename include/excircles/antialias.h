@@ -0,0 +1,55 @@
+//
+// antialias.h
+//
+// Anti-aliased lines and 4 bit alpha bitmaps
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _antialias_h
+#define _antialias_h
+
+#include <circle/types.h>
+#include <excircles/display.h>
+
+#define AA_ALPHA_LEVELS             16
+#define AA_LINE_BUFFER_SIZE         128
+
+// The panels cannot be read back, so coverage is blended against a known
+// background color. All blending goes through a table with one entry per
+// alpha level that is rebuilt only when the colors change.
+class AntiAlias
+{
+public:
+    AntiAlias(DisplayDevice *_display);
+    ~AntiAlias(void);
+
+    void SetColor(u16 _fg, u16 _bg);
+    // Xiaolin Wu's line
+    void DrawLine(int _x1, int _y1, int _x2, int _y2);
+    // _alpha holds two pixels per byte, high nibble first, rows start on
+    // a byte boundary
+    void DrawAlphaBitmap(unsigned _x, unsigned _y, unsigned _width, unsigned _height,
+                         const u8 *_alpha);
+
+private:
+    void PlotPair(int _x, int _y, boolean _steep, unsigned _alpha);
+
+private:
+    DisplayDevice *display;
+    u16 blend[AA_ALPHA_LEVELS];
+    u16 lineBuffer[AA_LINE_BUFFER_SIZE];
+};
+
+#endif // _antialias_h
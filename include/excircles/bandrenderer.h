@@ -0,0 +1,90 @@
+//
+// bandrenderer.h
+//
+// Full frame rendering in horizontal bands spread over all cores
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _bandrenderer_h
+#define _bandrenderer_h
+
+#include <circle/sysconfig.h>
+#include <circle/types.h>
+
+#ifdef ARM_ALLOW_MULTI_CORE
+
+#include <circle/memory.h>
+#include <circle/multicore.h>
+#include <excircles/display.h>
+#include <excircles/spscqueue.h>
+
+// lines in one band
+#define BAND_RENDERER_LINES         16
+// band buffers of each core
+#define BAND_RENDERER_BUFFERS       2
+// bytes of scratch memory each core gets for its bands
+#define BAND_RENDERER_SCRATCH_SIZE  4096
+
+// render _lines full width lines starting at line _y into _pixels;
+// _scratch belongs to the calling core for the duration of the call
+typedef void BandRenderCallback(unsigned _y, unsigned _lines, u16 *_pixels,
+                                unsigned _width, void *_scratch, void *_param);
+
+// Render() splits the frame into bands of BAND_RENDERER_LINES lines and
+// hands band n to core n mod CORES, the callback runs on all cores at
+// once. Each core has its own band buffers and scratch memory. Core 0
+// sends the bands in scan order as soon as each one is done, so the
+// transfer starts with the first band, not after the whole frame. The
+// only thing the cores share are single producer, single consumer queues
+// of band buffers.
+//
+// Circle supports one CMultiCoreSupport instance, so this cannot be used
+// together with FlushPipeline, which keeps core 1 for display transfers.
+class BandRenderer : public CMultiCoreSupport
+{
+public:
+    BandRenderer(CMemorySystem *_memory, DisplayDevice *_display);
+    ~BandRenderer(void);
+    // allocates the buffers and starts the secondary cores
+    boolean Initialize(void);
+
+    // core 0 only, returns when the whole frame was sent
+    void Render(BandRenderCallback *_callback, void *_param = 0);
+
+    void Run(unsigned _core);
+
+private:
+    void RenderBand(unsigned _core, unsigned _band, u16 *_pixels);
+
+private:
+    DisplayDevice *display;
+    unsigned bands;
+    u16 *buffers[CORES][BAND_RENDERER_BUFFERS];
+    u8 *scratch[CORES];
+
+    // rendered bands of a secondary core on their way to core 0
+    SPSCQueue<u16 *, BAND_RENDERER_BUFFERS + 1> readyBands[CORES];
+    // sent band buffers on their way back
+    SPSCQueue<u16 *, BAND_RENDERER_BUFFERS + 1> freeBuffers[CORES];
+
+    BandRenderCallback * volatile callback;
+    void * volatile callbackParam;
+    // bumped by core 0 to start a frame
+    volatile unsigned frame;
+};
+
+#endif // ARM_ALLOW_MULTI_CORE
+
+#endif // _bandrenderer_h
@@ -0,0 +1,111 @@
+//
+// blitter.h
+//
+// Scaling and rotating blitter with a viewport over a large canvas
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _blitter_h
+#define _blitter_h
+
+#include <circle/types.h>
+#include <excircles/display.h>
+
+enum BlitFilter
+{
+    BlitFilterNearest,
+    BlitFilterBilinear
+};
+
+// 1.0 in the 16.16 fixed point format used for the scale
+#define BLIT_SCALE_ONE              0x10000
+// edge length of the resampled tiles kept in the cache
+#define BLIT_TILE_SIZE              32
+
+// The source is scaled and rotated about its center into a canvas that
+// just holds the result; the viewport shows a part of the canvas on the
+// display. Resampled canvas tiles are cached, so panning only resamples
+// the tiles that scroll into view. Changing the source, the transform or
+// the filter drops the cache.
+class Blitter
+{
+public:
+    Blitter(DisplayDevice *_display);
+    ~Blitter(void);
+
+    // keeps the transform, e.g. for animation frames; the canvas size
+    // follows the new source
+    void SetSource(const Image565 *_source);
+    void SetFilter(BlitFilter _filter);
+    // _scale is 16.16 fixed point, _angle is in degrees counter clockwise
+    void SetTransform(unsigned _scale, unsigned _angle = 0);
+    // color of canvas pixels not covered by the source
+    void SetBackground(u16 _color);
+    // part of the display the canvas is shown in
+    boolean SetViewport(unsigned _x, unsigned _y, unsigned _width, unsigned _height);
+
+    unsigned GetCanvasWidth(void) const { return canvasWidth; }
+    unsigned GetCanvasHeight(void) const { return canvasHeight; }
+
+    // show the canvas with (_panX, _panY) at the top left of the viewport
+    void Draw(int _panX, int _panY);
+
+    // tiles resampled and tiles served from the cache by the last Draw()
+    unsigned GetTilesResampled(void) const { return tilesResampled; }
+    unsigned GetTilesCached(void) const { return tilesCached; }
+
+private:
+    void Invalidate(void);
+    const u16 *GetTile(int _tileX, int _tileY);
+    void Resample(u16 *_tile, int _canvasX, int _canvasY);
+    u16 Fetch(int _x, int _y) const;
+
+private:
+    DisplayDevice *display;
+    Image565 source;
+    BlitFilter filter;
+    u16 background;
+
+    // as passed to SetTransform()
+    unsigned scale;
+    unsigned angle;
+    // canvas to source mapping in 16.16 fixed point
+    s32 mapXX;
+    s32 mapXY;
+    s32 mapYX;
+    s32 mapYY;
+    s64 originX;
+    s64 originY;
+    unsigned canvasWidth;
+    unsigned canvasHeight;
+
+    unsigned viewX;
+    unsigned viewY;
+    unsigned viewWidth;
+    unsigned viewHeight;
+    u16 *lineBuffer;
+
+    // direct mapped cache, a tile lives in slot (x mod columns, y mod rows)
+    unsigned tileColumns;
+    unsigned tileRows;
+    u16 *tiles;
+    int *tileTagX;
+    int *tileTagY;
+    boolean *tileValid;
+    unsigned tilesResampled;
+    unsigned tilesCached;
+};
+
+#endif // _blitter_h
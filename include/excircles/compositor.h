@@ -0,0 +1,92 @@
+//
+// compositor.h
+//
+// Tile based compositor for sprite and overlay layers over a background
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _compositor_h
+#define _compositor_h
+
+#include <circle/types.h>
+#include <excircles/display.h>
+
+#define COMPOSITOR_MAX_LAYERS       8
+// edge length of the tiles the screen is tracked in
+#define COMPOSITOR_TILE_SIZE        16
+
+struct CompositorLayer
+{
+    Image565 image;
+    int x;
+    int y;
+    boolean visible;
+    // pixels equal to key are not drawn
+    boolean transparent;
+    u16 key;
+};
+
+// The screen is made of a background and up to COMPOSITOR_MAX_LAYERS
+// layers, higher numbered layers are drawn on top. Changing a layer marks
+// the tiles under its old and its new position; Update() composites only
+// those tiles and sends each horizontal run of them as one window.
+class Compositor
+{
+public:
+    Compositor(DisplayDevice *_display);
+    ~Compositor(void);
+    boolean Initialize(void);
+
+    // background image, must cover the whole display
+    void SetBackground(const Image565 *_image);
+    // plain background, used when no background image is set
+    void SetBackgroundColor(u16 _color);
+
+    void SetLayer(unsigned _layer, const Image565 *_image);
+    void SetLayerKey(unsigned _layer, u16 _key);
+    void MoveLayer(unsigned _layer, int _x, int _y);
+    void ShowLayer(unsigned _layer, boolean _visible);
+    // layer image content changed
+    void InvalidateLayer(unsigned _layer);
+    // area of the screen to composite again, e.g. the background changed
+    void Invalidate(unsigned _x, unsigned _y, unsigned _width, unsigned _height);
+
+    void Update(void);
+
+    // tiles and windows sent by the last Update()
+    unsigned GetTilesSent(void) const { return tilesSent; }
+    unsigned GetWindowsSent(void) const { return windowsSent; }
+
+private:
+    void MarkLayer(unsigned _layer);
+    void MarkArea(int _x, int _y, int _width, int _height);
+    void Compose(unsigned _x0, unsigned _x1, unsigned _y0, unsigned _y1);
+
+private:
+    DisplayDevice *display;
+    Image565 background;
+    u16 backgroundColor;
+    CompositorLayer layers[COMPOSITOR_MAX_LAYERS];
+
+    unsigned tileColumns;
+    unsigned tileRows;
+    u8 *dirtyTiles;
+    // one row of tiles
+    u16 *spanBuffer;
+    unsigned tilesSent;
+    unsigned windowsSent;
+};
+
+#endif // _compositor_h
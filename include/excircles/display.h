@@ -0,0 +1,79 @@
+//
+// display.h
+//
+// Common interface of the graphical LCD device drivers
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _display_h
+#define _display_h
+
+#include <circle/device.h>
+#include <circle/types.h>
+
+// RGB565 image in memory, pitch is in pixels
+struct Image565
+{
+    const u16 *pixels;
+    unsigned width;
+    unsigned height;
+    unsigned pitch;
+};
+
+// layout of the pixels as they go out to the controller
+enum DisplayPixelFormat
+{
+    // two bytes per pixel, high byte first
+    DisplayPixelFormatRGB565,
+    // three bytes per pixel red, green, blue with 6 bits each
+    DisplayPixelFormatRGB666,
+    // three bytes per pixel red, green, blue
+    DisplayPixelFormatRGB888
+};
+
+// Window based pixel access shared by all display drivers. Pixels are
+// always passed as RGB565 in host byte order; each driver converts them
+// to the wire format of its controller.
+class DisplayDevice : public CDevice
+{
+public:
+    DisplayDevice(unsigned _width, unsigned _height);
+    virtual ~DisplayDevice(void);
+
+    unsigned GetWidth(void) const { return width; }
+    unsigned GetHeight(void) const { return height; }
+
+    // select the window (inclusive coordinates) subsequent pixels go to
+    virtual void SetXY(unsigned _x0, unsigned _x1, unsigned _y0, unsigned _y1) = 0;
+    // stream pixels into the current window
+    virtual void WritePixels(const u16 *_pixels, unsigned _count) = 0;
+    // stream the same pixel _count times into the current window
+    virtual void FillPixels(u16 _color, unsigned _count) = 0;
+
+    // format taken by WriteRaw()
+    virtual DisplayPixelFormat GetPixelFormat(void) const { return DisplayPixelFormatRGB565; }
+    unsigned GetBytesPerPixel(void) const;
+    // stream pixels already in the wire format into the current window,
+    // drivers send the data as is
+    virtual void WriteRaw(const u8 *_data, unsigned _length);
+
+    void FillRect(unsigned _x, unsigned _y, unsigned _width, unsigned _height, u16 _color);
+
+protected:
+    unsigned width;
+    unsigned height;
+};
+
+#endif // _display_h
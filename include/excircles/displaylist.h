@@ -0,0 +1,126 @@
+//
+// displaylist.h
+//
+// Recorded draw commands, optimized and executed later
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _displaylist_h
+#define _displaylist_h
+
+#include <circle/chargenerator.h>
+#include <circle/types.h>
+#include <excircles/display.h>
+
+#define DISPLAYLIST_ARENA_SIZE      4096
+#define DISPLAYLIST_MAX_COMMANDS    128
+
+enum DisplayListCommandType
+{
+    DisplayListFill,
+    DisplayListLine,
+    DisplayListText,
+    DisplayListBlit
+};
+
+// one recorded command in the arena, text commands are followed by the
+// characters
+struct DisplayListCommand
+{
+    u8 type;
+    u8 length;
+    u16 size;
+    // bounding box on the screen, inclusive
+    s16 x0;
+    s16 y0;
+    s16 x1;
+    s16 y1;
+    u16 fg;
+    u16 bg;
+    union {
+        // line end points
+        s16 points[4];
+        const Image565 *image;
+    };
+};
+
+// what Execute() works on, one per recorded command
+struct DisplayListEntry
+{
+    const DisplayListCommand *command;
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+    boolean opaque;
+    boolean live;
+};
+
+// Commands are recorded into a fixed arena and stay there until Clear(),
+// so a static screen can be executed again (e.g. after the display was
+// reset) without recording it anew. Execute() drops commands that later
+// opaque commands cover completely, merges fills of one color that
+// together form a rectangle into one window, and sends what is left in
+// screen order as far as overlapping commands allow.
+class DisplayList
+{
+public:
+    DisplayList(DisplayDevice *_display, unsigned _arenaSize = DISPLAYLIST_ARENA_SIZE);
+    ~DisplayList(void);
+    boolean Initialize(void);
+
+    void Clear(void);
+    boolean Fill(int _x, int _y, unsigned _width, unsigned _height, u16 _color);
+    boolean Line(int _x0, int _y0, int _x1, int _y1, u16 _color);
+    // text is drawn with the background, cells are 8x16 pixels
+    boolean Text(int _x, int _y, const char *_text, u16 _fg, u16 _bg);
+    // the image must stay valid until the list is cleared
+    boolean Blit(int _x, int _y, const Image565 *_image);
+
+    void Execute(void);
+
+    unsigned GetCommandCount(void) const { return commandCount; }
+    // commands dropped as covered and merged into others by the last Execute()
+    unsigned GetCulled(void) const { return culled; }
+    unsigned GetMerged(void) const { return merged; }
+
+private:
+    DisplayListCommand *Allocate(DisplayListCommandType _type, unsigned _extra);
+    void Cull(void);
+    void Merge(void);
+    unsigned Sort(void);
+    void Run(const DisplayListEntry &_entry);
+    void FillClipped(int _x0, int _y0, int _x1, int _y1, u16 _color);
+    void DrawLine(const DisplayListCommand &_command);
+    void DrawText(const DisplayListCommand &_command);
+    void DrawBlit(const DisplayListCommand &_command);
+
+private:
+    DisplayDevice *display;
+    CCharGenerator font;
+    unsigned arenaSize;
+    u8 *memory;
+    // memory aligned for the command records
+    u8 *arena;
+    unsigned arenaUsed;
+    DisplayListEntry *entries;
+    unsigned *order;
+    unsigned commandCount;
+    u16 *lineBuffer;
+    unsigned culled;
+    unsigned merged;
+};
+
+#endif // _displaylist_h
@@ -0,0 +1,102 @@
+//
+// flushpipeline.h
+//
+// Display transfers on a second core, fed through lock free queues
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _flushpipeline_h
+#define _flushpipeline_h
+
+#include <circle/sysconfig.h>
+#include <circle/types.h>
+
+#ifdef ARM_ALLOW_MULTI_CORE
+
+#include <circle/memory.h>
+#include <circle/multicore.h>
+#include <excircles/display.h>
+#include <excircles/displaylist.h>
+#include <excircles/spscqueue.h>
+
+// requests in flight between the cores, plus one
+#define FLUSH_PIPELINE_QUEUE_SIZE   9
+// the core that owns the display
+#define FLUSH_PIPELINE_CORE         1
+
+enum FlushRequestType
+{
+    // send pixels into a window
+    FlushRequestPixels,
+    // execute a display list
+    FlushRequestList
+};
+
+struct FlushRequest
+{
+    FlushRequestType type;
+    const u16 *pixels;
+    DisplayList *list;
+    // window of a pixels request, inclusive
+    unsigned x0;
+    unsigned x1;
+    unsigned y0;
+    unsigned y1;
+    // handed back with the completed request
+    void *param;
+};
+
+// Core 0 renders and submits, core 1 does all the bus traffic of the
+// display, so rendering the next frame overlaps sending the last one.
+// Submitted pixels and display lists belong to core 1 until they come
+// back through GetCompleted(), in submission order. Once the pipeline runs
+// the display must not be used from core 0 directly.
+//
+// Circle supports one CMultiCoreSupport instance, so this cannot be used
+// together with BandRenderer, which renders on all cores.
+class FlushPipeline : public CMultiCoreSupport
+{
+public:
+    FlushPipeline(CMemorySystem *_memory, DisplayDevice *_display);
+    ~FlushPipeline(void);
+    // starts the secondary cores
+    boolean Initialize(void);
+
+    // core 0 side, FALSE when the queue is full
+    boolean SubmitPixels(const u16 *_pixels, unsigned _x0, unsigned _x1,
+                         unsigned _y0, unsigned _y1, void *_param = 0);
+    boolean SubmitList(DisplayList *_list, void *_param = 0);
+    // FALSE when nothing has completed since the last call
+    boolean GetCompleted(FlushRequest *_request);
+    // submitted and not yet handed back
+    unsigned GetInFlight(void) const { return inFlight; }
+    // wait until everything submitted was sent
+    void Sync(void);
+
+    void Run(unsigned _core);
+
+private:
+    void Execute(const FlushRequest &_request);
+
+private:
+    DisplayDevice *display;
+    SPSCQueue<FlushRequest, FLUSH_PIPELINE_QUEUE_SIZE> submitted;
+    SPSCQueue<FlushRequest, FLUSH_PIPELINE_QUEUE_SIZE> completed;
+    unsigned inFlight;
+};
+
+#endif // ARM_ALLOW_MULTI_CORE
+
+#endif // _flushpipeline_h
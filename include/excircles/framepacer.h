@@ -0,0 +1,104 @@
+//
+// framepacer.h
+//
+// Frame rate pacing with render and flush time accounting
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _framepacer_h
+#define _framepacer_h
+
+#include <circle/types.h>
+
+// frames per second while nothing changes
+#define FRAME_PACER_IDLE_FPS        5
+// unchanged frames in a row before dropping to the idle rate
+#define FRAME_PACER_IDLE_FRAMES     30
+
+// advance the picture by _frames frame periods of the full rate, more
+// than one when the frames before were dropped or the pacer was idle;
+// return FALSE when nothing changed
+typedef boolean FramePacerRender(unsigned _frames, void *_param);
+// send what was rendered to the display
+typedef void FramePacerFlush(void *_param);
+
+// Call Tick() at least at the target rate, a RunLoop timer with the frame
+// period is the natural choice. Each Tick() that finds a frame due
+// renders it and, if the picture changed, flushes it. Times are taken
+// with CTimer clock ticks.
+//
+// A frame that takes longer than the frame period is counted late. The
+// deadlines it overran are not made up for: those frames are dropped and
+// the next render call covers all of them at once, so the animation
+// keeps its speed instead of falling further behind. After
+// FRAME_PACER_IDLE_FRAMES unchanged frames the pacer only renders at the
+// idle rate until a frame changes again or Wake() is called. The frame
+// count passed to the render call stays in full rate periods, so time
+// based content like a clock keeps its speed; the skipped frames are not
+// counted as dropped.
+class FramePacer
+{
+public:
+    FramePacer(unsigned _fps, unsigned _idleFps = FRAME_PACER_IDLE_FPS);
+    ~FramePacer(void);
+
+    void SetCallbacks(FramePacerRender *_render, FramePacerFlush *_flush = 0, void *_param = 0);
+
+    // TRUE when a frame was rendered
+    boolean Tick(void);
+    // back to the full rate with the next Tick(), e.g. on input
+    void Wake(void);
+    boolean IsIdle(void) const { return idle; }
+
+    // frames flushed to the display
+    unsigned GetDelivered(void) const { return delivered; }
+    // frame periods skipped because a frame overran
+    unsigned GetDropped(void) const { return dropped; }
+    // frames that took longer than the frame period
+    unsigned GetLate(void) const { return late; }
+    // microseconds, of the last frame
+    unsigned GetRenderTime(void) const { return renderTime; }
+    unsigned GetFlushTime(void) const { return flushTime; }
+    // microseconds, the longest render plus flush so far
+    unsigned GetMaxFrameTime(void) const { return maxFrameTime; }
+    void ResetStats(void);
+
+private:
+    FramePacerRender *render;
+    FramePacerFlush *flush;
+    void *param;
+    // microseconds
+    unsigned period;
+    unsigned idlePeriod;
+
+    boolean started;
+    // CTimer::GetClockTicks() at the next due frame of the full rate, and
+    // of the idle rate while idle
+    unsigned deadline;
+    unsigned idleDeadline;
+    boolean idle;
+    // the frames since the last render were skipped by idling
+    boolean skipped;
+    unsigned unchanged;
+
+    unsigned delivered;
+    unsigned dropped;
+    unsigned late;
+    unsigned renderTime;
+    unsigned flushTime;
+    unsigned maxFrameTime;
+};
+
+#endif // _framepacer_h
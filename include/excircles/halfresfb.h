@@ -0,0 +1,53 @@
+//
+// halfresfb.h
+//
+// Half resolution framebuffer, pixels are doubled on the way out
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _halfresfb_h
+#define _halfresfb_h
+
+#include <circle/types.h>
+#include <excircles/memorydisplay.h>
+
+// A DisplayDevice of half the width and height of the display it is
+// attached to (120x160 for ILI9341, 64x64 for SSD1351), so everything
+// that draws to a display can draw here at a quarter of the cost. Flush()
+// packs each changed row once, every pixel doubled, straight into a line
+// in the wire format of the display and hands that line to WriteRaw()
+// twice; there is no full resolution copy and no second packing pass in
+// the driver.
+class HalfResFrameBuffer : public MemoryDisplayDevice
+{
+public:
+    HalfResFrameBuffer(DisplayDevice *_display);
+    ~HalfResFrameBuffer(void);
+    boolean Initialize(void);
+
+    // direct access, report changes with MarkDirty()
+    u16 *GetBuffer(void) { return (u16 *)buffer; }
+
+    // send the bounding box of everything changed since the last flush
+    void Flush(void);
+
+private:
+    DisplayDevice *display;
+    DisplayPixelFormat format;
+    // one doubled row in the wire format
+    u8 *lineBuffer;
+};
+
+#endif // _halfresfb_h
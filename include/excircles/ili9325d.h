@@ -20,11 +20,11 @@
 #ifndef _ili9325d_h
 #define _ili9325d_h
 
-#include <circle/device.h>
 #include <circle/gpiopin.h>
 #include <circle/types.h>
+#include <excircles/display.h>
 
-class ILI9325DDevice : public CDevice
+class ILI9325DDevice : public DisplayDevice
 {
 public:
     ILI9325DDevice(u8 _db0, u8 _db1, u8 _db2, u8 _db3, u8 _db4, u8 _db5, u8 _db6, u8 _db7,
@@ -35,6 +35,9 @@ public:
     void WriteData(unsigned _data);
     void WriteCommandData(unsigned _cmd, unsigned _data);
     void SetXY(unsigned _x0, unsigned _x1, unsigned _y0, unsigned _y1);
+    void WritePixels(const u16 *_pixels, unsigned _count);
+    void FillPixels(u16 _color, unsigned _count);
+    void WriteRaw(const u8 *_data, unsigned _length);
     void Paint(unsigned _color);
     void Clear(void);
 
@@ -20,36 +20,288 @@
 #ifndef _ili9341_h
 #define _ili9341_h
 
-#include <circle/device.h>
 #include <circle/gpiopin.h>
+#include <circle/logger.h>
+#include <circle/timer.h>
 #include <circle/types.h>
-#ifndef USE_SPI_MASTER_AUX
-#include <circle/spimaster.h>
-#else
-#include <circle/spimasteraux.h>
-#endif
+#include <excircles/pixelformat.h>
+#include <excircles/queueddisplay.h>
+#include <excircles/spibus.h>
+#include <assert.h>
 
-class ILI9341Device : public CDevice
+#define ILI9341_WIDTH               240
+#define ILI9341_HEIGHT              320
+// size of the buffer pixels are packed into before going out over SPI
+#define ILI9341_TX_BUFFER_SIZE      512
+
+// Bus is SPIBus or any other class with its Write() calls, see spibus.h
+template <class Bus>
+class ILI9341DeviceT : public QueuedDisplayDevice
 {
 public:
-	ILI9341Device(CSPIMaster *_SPIMaster, unsigned _cs, unsigned _rs);
-	~ILI9341Device(void);
+	ILI9341DeviceT(Bus _bus, unsigned _cs, unsigned _rs);
+	~ILI9341DeviceT(void);
 	boolean Initialize(void);
 	void WriteCommand(unsigned _cmd);
 	void WriteData(unsigned _data);
 	void SetXY(unsigned _x0, unsigned _x1, unsigned _y0, unsigned _y1);
+	void WritePixels(const u16 *_pixels, unsigned _count);
+	void FillPixels(u16 _color, unsigned _count);
+	void WriteRaw(const u8 *_data, unsigned _length);
+
+	// see QueuedDisplayDevice
+	boolean SetXYAsync(unsigned _x0, unsigned _x1, unsigned _y0, unsigned _y1,
+	                   SPIQueueCallback *_callback = 0, void *_param = 0);
+	boolean WritePixelsAsync(const u16 *_pixels, unsigned _count,
+	                         SPIQueueCallback *_callback = 0, void *_param = 0);
+
 	void Paint(unsigned _color);
 	void Clear(void);
     void Square(unsigned _x, unsigned _y, unsigned _size, unsigned _color);
 
 private:
-#ifndef USE_SPI_MASTER_AUX
-	CSPIMaster *SPIMaster;
-#else
-	CSPIMasterAUX *SPIMaster;
-#endif
+	// log source, a member so that every instantiation shares one definition
+	static const char FromILI9341[];
+
+	Bus bus;
     unsigned cs;
 	CGPIOPin rs;
+	u8 txBuffer[ILI9341_TX_BUFFER_SIZE];
 };
 
+template <class Bus>
+const char ILI9341DeviceT<Bus>::FromILI9341[] = "ili9341";
+
+template <class Bus>
+ILI9341DeviceT<Bus>::ILI9341DeviceT(Bus _bus, unsigned _cs, unsigned _rs)
+    : QueuedDisplayDevice(ILI9341_WIDTH, ILI9341_HEIGHT),
+      bus(_bus),
+      cs(_cs),
+      rs(_rs, GPIOModeOutput)
+{
+}
+
+template <class Bus>
+ILI9341DeviceT<Bus>::~ILI9341DeviceT(void)
+{
+}
+
+template <class Bus>
+boolean ILI9341DeviceT<Bus>::Initialize(void)
+{
+    // initialize
+    WriteCommand(0x11);
+    CTimer::SimpleMsDelay(20);
+    WriteCommand(0x28);
+    CTimer::SimpleMsDelay(5);
+    WriteCommand(0xCF);
+    WriteData(0x00);
+    WriteData(0x83);
+    WriteData(0x30);
+    WriteCommand(0xED);
+    WriteData(0x64);
+    WriteData(0x03);
+    WriteData(0x12);
+    WriteData(0x81);
+    WriteCommand(0xE8);
+    WriteData(0x85);
+    WriteData(0x01);
+    WriteData(0x79);
+    WriteCommand(0xCB);
+    WriteData(0x39);
+    WriteData(0X2C);
+    WriteData(0x00);
+    WriteData(0x34);
+    WriteData(0x02);
+    WriteCommand(0xF7);
+    WriteData(0x20);
+    WriteCommand(0xEA);
+    WriteData(0x00);
+    WriteData(0x00);
+    WriteCommand(0xC0);
+    WriteData(0x26);
+    WriteCommand(0xC1);
+    WriteData(0x11);
+    WriteCommand(0xC5);
+    WriteData(0x35);
+    WriteData(0x3E);
+    WriteCommand(0xC7);
+    WriteData(0xBE);
+    WriteCommand(0xB1);
+    WriteData(0x00);
+    WriteData(0x1B);
+    WriteCommand(0xB6);
+    WriteData(0x0A);
+    WriteData(0x82);
+    WriteData(0x27);
+    WriteData(0x00);
+    WriteCommand(0xB7);
+    WriteData(0x07);
+    WriteCommand(0x3A);
+    WriteData(0x55);
+    WriteCommand(0x36);
+    WriteData((1<<3)|(1<<6));
+    WriteCommand(0x29);
+    CTimer::SimpleMsDelay(5);
+
+    CLogger::Get()->Write(FromILI9341, LogNotice, "ILI9341 intialized!");
+    return TRUE;
+}
+
+template <class Bus>
+void ILI9341DeviceT<Bus>::WriteCommand(unsigned _cmd)
+{
+    rs.Write(LOW);
+    u8 cmd = (u8)_cmd;
+    if (bus.Write(cs, &cmd, 1) != 1) {
+        CLogger::Get()->Write(FromILI9341, LogError, "SPI write error");
+    }
+}
+
+template <class Bus>
+void ILI9341DeviceT<Bus>::WriteData(unsigned _data)
+{
+    rs.Write(HIGH);
+    u8 data = (u8)_data;
+    if (bus.Write(cs, &data, 1) != 1) {
+        CLogger::Get()->Write(FromILI9341, LogError, "SPI write error");
+    }
+}
+
+template <class Bus>
+void ILI9341DeviceT<Bus>::SetXY(unsigned _x0, unsigned _x1, unsigned _y0, unsigned _y1)
+{
+    // column
+    WriteCommand(0x2A);
+    WriteData(_x0>>8);
+    WriteData(_x0);
+    WriteData(_x1>>8);
+    WriteData(_x1);
+    // page
+    WriteCommand(0x2B);
+    WriteData(_y0>>8);
+    WriteData(_y0);
+    WriteData(_y1>>8);
+    WriteData(_y1);
+    // write
+    WriteCommand(0x2C);
+}
+
+template <class Bus>
+void ILI9341DeviceT<Bus>::WritePixels(const u16 *_pixels, unsigned _count)
+{
+    rs.Write(HIGH);
+    while (_count > 0) {
+        unsigned n = _count;
+        if (n > ILI9341_TX_BUFFER_SIZE / 2) {
+            n = ILI9341_TX_BUFFER_SIZE / 2;
+        }
+        PackPixels<PixelFormatRGB565>(txBuffer, _pixels, n);
+        if (bus.Write(cs, txBuffer, 2*n) != (int)(2*n)) {
+            CLogger::Get()->Write(FromILI9341, LogError, "SPI write error");
+            return;
+        }
+        _pixels += n;
+        _count -= n;
+    }
+}
+
+template <class Bus>
+void ILI9341DeviceT<Bus>::FillPixels(u16 _color, unsigned _count)
+{
+    unsigned n = _count;
+    if (n > ILI9341_TX_BUFFER_SIZE / 2) {
+        n = ILI9341_TX_BUFFER_SIZE / 2;
+    }
+    // the buffer content is the same for every chunk
+    PackFill<PixelFormatRGB565>(txBuffer, _color, n);
+
+    rs.Write(HIGH);
+    while (_count > 0) {
+        n = _count;
+        if (n > ILI9341_TX_BUFFER_SIZE / 2) {
+            n = ILI9341_TX_BUFFER_SIZE / 2;
+        }
+        if (bus.Write(cs, txBuffer, 2*n) != (int)(2*n)) {
+            CLogger::Get()->Write(FromILI9341, LogError, "SPI write error");
+            return;
+        }
+        _count -= n;
+    }
+}
+
+template <class Bus>
+void ILI9341DeviceT<Bus>::WriteRaw(const u8 *_data, unsigned _length)
+{
+    rs.Write(HIGH);
+    if (bus.Write(cs, _data, _length) != (int)_length) {
+        CLogger::Get()->Write(FromILI9341, LogError, "SPI write error");
+    }
+}
+
+template <class Bus>
+boolean ILI9341DeviceT<Bus>::SetXYAsync(unsigned _x0, unsigned _x1, unsigned _y0, unsigned _y1,
+                                  SPIQueueCallback *_callback, void *_param)
+{
+    assert(queue != 0);
+    // all or nothing, a half set window would break the next write
+    if (queue->GetFree() < 5) {
+        return FALSE;
+    }
+
+    const u8 column = 0x2A;
+    const u8 page = 0x2B;
+    const u8 write = 0x2C;
+    u8 x[4] = {(u8)(_x0>>8), (u8)_x0, (u8)(_x1>>8), (u8)_x1};
+    u8 y[4] = {(u8)(_y0>>8), (u8)_y0, (u8)(_y1>>8), (u8)_y1};
+
+    queue->WriteInline(cs, &rs, LOW, &column, 1);
+    queue->WriteInline(cs, &rs, HIGH, x, sizeof(x));
+    queue->WriteInline(cs, &rs, LOW, &page, 1);
+    queue->WriteInline(cs, &rs, HIGH, y, sizeof(y));
+    queue->WriteInline(cs, &rs, LOW, &write, 1, 0, _callback, _param);
+
+    return TRUE;
+}
+
+template <class Bus>
+boolean ILI9341DeviceT<Bus>::WritePixelsAsync(const u16 *_pixels, unsigned _count,
+                                        SPIQueueCallback *_callback, void *_param)
+{
+    assert(queue != 0);
+
+    return queue->WritePixels(cs, &rs, HIGH, _pixels, _count,
+                              PackPixels<PixelFormatRGB565>, PixelFormatRGB565::BytesPerPixel,
+                              _callback, _param);
+}
+
+template <class Bus>
+void ILI9341DeviceT<Bus>::Paint(unsigned _color)
+{
+    SetXY(0, ILI9341_WIDTH-1, 0, ILI9341_HEIGHT-1);
+    FillPixels(_color, ILI9341_WIDTH * ILI9341_HEIGHT);
+}
+
+template <class Bus>
+void ILI9341DeviceT<Bus>::Clear(void)
+{
+    Paint(0x0000);
+}
+
+template <class Bus>
+void ILI9341DeviceT<Bus>::Square(unsigned _x, unsigned _y, unsigned _size, unsigned _color)
+{
+    SetXY(_x, _x + _size-1, _y, _y + _size-1);
+    FillPixels(_color, _size * _size);
+}
+
+typedef ILI9341DeviceT<SPIBus> ILI9341Device;
+
+// the library instantiates the drivers for its own bus types, other ones
+// like the mock bus of test/drivertest.cpp are instantiated where they
+// are used
+extern template class ILI9341DeviceT<SPIBus>;
+extern template class ILI9341DeviceT<SPIMasterBus>;
+extern template class ILI9341DeviceT<SPIMasterAUXBus>;
+
 #endif // _ili9341_h
@@ -0,0 +1,87 @@
+//
+// indexedfb.h
+//
+// Palette indexed framebuffer with 8, 4, 2 or 1 bits per pixel
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _indexedfb_h
+#define _indexedfb_h
+
+#include <circle/types.h>
+#include <excircles/display.h>
+
+// bytes of a pixel in the widest wire format
+#define INDEXED_FB_MAX_BYTES_PER_PIXEL  3
+
+// Pixels are palette indices packed into bytes, the leftmost pixel in the
+// most significant bits. The palette is kept in the wire format of the
+// display as well, so Flush() looks each changed row up straight into
+// that format and hands it to WriteRaw(); there is no RGB565 copy of the
+// frame or the row and no second packing pass in the driver. Changing
+// the palette redraws the whole screen, which is the cheap way to recolor
+// or fade everything at once.
+class IndexedFrameBuffer
+{
+public:
+    // _bits is 1, 2, 4 or 8
+    IndexedFrameBuffer(DisplayDevice *_display, unsigned _bits);
+    ~IndexedFrameBuffer(void);
+    boolean Initialize(void);
+
+    unsigned GetColors(void) const { return 1 << bits; }
+    void SetPalette(const u16 *_colors, unsigned _count, unsigned _first = 0);
+    void SetPaletteEntry(unsigned _index, u16 _color);
+
+    void DrawPixel(unsigned _x, unsigned _y, u8 _index);
+    u8 GetPixel(unsigned _x, unsigned _y) const;
+    void FillRect(unsigned _x, unsigned _y, unsigned _width, unsigned _height, u8 _index);
+    void Clear(u8 _index);
+
+    // direct access, report changes with MarkDirty()
+    u8 *GetBuffer(void) { return buffer; }
+    unsigned GetPitch(void) const { return pitch; }
+    void MarkDirty(unsigned _x, unsigned _y, unsigned _width, unsigned _height);
+
+    // send the bounding box of everything changed since the last flush
+    void Flush(void);
+
+private:
+    void SetIndex(u8 *_row, unsigned _x, u8 _index);
+
+private:
+    DisplayDevice *display;
+    DisplayPixelFormat format;
+    unsigned bytesPerPixel;
+    unsigned bits;
+    unsigned pitch;
+    u8 *buffer;
+    // one row in the wire format
+    u8 *wireRow;
+    u16 palette[256];
+    // the palette in the wire format
+    u8 wirePalette[256 * INDEXED_FB_MAX_BYTES_PER_PIXEL];
+    // both pixels of every possible byte in the wire format, 4 bit mode
+    // only
+    u8 *pairs;
+
+    boolean dirty;
+    unsigned dirtyX0;
+    unsigned dirtyY0;
+    unsigned dirtyX1;
+    unsigned dirtyY1;
+};
+
+#endif // _indexedfb_h
@@ -0,0 +1,92 @@
+//
+// linerenderer.h
+//
+// Renders the screen a few lines at a time without a framebuffer
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _linerenderer_h
+#define _linerenderer_h
+
+#include <circle/types.h>
+#include <excircles/display.h>
+
+// lines rendered into one buffer before it is sent
+#define LINE_RENDERER_LINES         8
+#define LINE_RENDERER_BUFFERS       2
+#define LINE_RENDERER_MAX_PRIMITIVES 32
+
+enum LinePrimitiveType
+{
+    LinePrimitiveRect,
+    LinePrimitiveGradientH,
+    LinePrimitiveGradientV
+};
+
+struct LinePrimitive
+{
+    LinePrimitiveType type;
+    int x;
+    int y;
+    unsigned width;
+    unsigned height;
+    u16 color;
+    // end color of gradients
+    u16 color2;
+};
+
+// called for every line after the scene was drawn into it
+typedef void LineRendererCallback(unsigned _y, u16 *_line, unsigned _width, void *_param);
+
+// Render() goes down the screen, draws the background, the scene
+// primitives and the callback into a small line buffer and streams it to
+// the display, all in one full screen window. Buffers are used in turn so
+// a buffer is not touched again right after it was handed to the display.
+class LineRenderer
+{
+public:
+    LineRenderer(DisplayDevice *_display);
+    ~LineRenderer(void);
+    boolean Initialize(void);
+
+    void SetBackground(u16 _color);
+    void RegisterCallback(LineRendererCallback *_callback, void *_param = 0);
+
+    // scene primitives are drawn in the order they were added
+    void ClearScene(void);
+    boolean AddRect(int _x, int _y, unsigned _width, unsigned _height, u16 _color);
+    // color goes from _from at the left or top edge to _to at the other one
+    boolean AddGradient(int _x, int _y, unsigned _width, unsigned _height,
+                        u16 _from, u16 _to, boolean _vertical = FALSE);
+
+    void Render(void);
+
+private:
+    boolean Add(const LinePrimitive &_primitive);
+    void RenderLine(unsigned _y, u16 *_line);
+
+private:
+    DisplayDevice *display;
+    u16 *buffers[LINE_RENDERER_BUFFERS];
+    unsigned nextBuffer;
+    u16 background;
+    LineRendererCallback *callback;
+    void *callbackParam;
+
+    LinePrimitive scene[LINE_RENDERER_MAX_PRIMITIVES];
+    unsigned sceneCount;
+};
+
+#endif // _linerenderer_h
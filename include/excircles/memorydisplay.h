@@ -0,0 +1,89 @@
+//
+// memorydisplay.h
+//
+// Display device drawing into memory, base of the framebuffers
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _memorydisplay_h
+#define _memorydisplay_h
+
+#include <circle/synchronize.h>
+#include <circle/types.h>
+#include <excircles/display.h>
+
+// start of the storage, so it can be handed to DMA as is
+#define MEMORY_DISPLAY_ALIGN        DATA_CACHE_LINE_LENGTH_MAX
+
+// A DisplayDevice whose pixels land in memory. It follows the window and
+// write position like the controllers do and keeps the bounding box of
+// everything changed since the last flush; the derived class decides
+// what a flush sends and where. Pixels are stored as RGB565 in host byte
+// order unless the derived class stores them its own way through
+// StorePixels(), StoreFill() and LoadPixel().
+class MemoryDisplayDevice : public DisplayDevice
+{
+public:
+    MemoryDisplayDevice(unsigned _width, unsigned _height, unsigned _bytesPerPixel = 2);
+    virtual ~MemoryDisplayDevice(void);
+    // allocates and clears the storage, everything is dirty afterwards
+    boolean Initialize(void);
+
+    void SetXY(unsigned _x0, unsigned _x1, unsigned _y0, unsigned _y1);
+    void WritePixels(const u16 *_pixels, unsigned _count);
+    void FillPixels(u16 _color, unsigned _count);
+
+    void DrawPixel(unsigned _x, unsigned _y, u16 _color);
+    u16 GetPixel(unsigned _x, unsigned _y) const;
+    unsigned GetPitch(void) const { return pitch; }
+    // reports changes made through the buffer, clipped to the display
+    void MarkDirty(unsigned _x, unsigned _y, unsigned _width, unsigned _height);
+
+protected:
+    // _count pixels on one row
+    virtual void StorePixels(u8 *_dst, const u16 *_pixels, unsigned _count);
+    virtual void StoreFill(u8 *_dst, u16 _color, unsigned _count);
+    virtual u16 LoadPixel(const u8 *_src) const;
+    // inclusive corners inside the display, the default grows the
+    // bounding box
+    virtual void AddDirty(unsigned _x0, unsigned _y0, unsigned _x1, unsigned _y1);
+
+    u8 *GetAddress(unsigned _x, unsigned _y) const { return &buffer[_y * pitch + _x * bytesPerPixel]; }
+    // pixels up to the end of the window row at the cursor, at most _count
+    unsigned GetRun(unsigned _count) const;
+    void Advance(unsigned _count);
+
+protected:
+    unsigned bytesPerPixel;
+    unsigned pitch;
+    u8 *memory;
+    u8 *buffer;
+
+    // current window and write position
+    unsigned windowX0;
+    unsigned windowX1;
+    unsigned windowY0;
+    unsigned windowY1;
+    unsigned cursorX;
+    unsigned cursorY;
+
+    boolean dirty;
+    unsigned dirtyX0;
+    unsigned dirtyY0;
+    unsigned dirtyX1;
+    unsigned dirtyY1;
+};
+
+#endif // _memorydisplay_h
@@ -0,0 +1,56 @@
+//
+// nativefb.h
+//
+// Framebuffer kept in the wire format of the display
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _nativefb_h
+#define _nativefb_h
+
+#include <circle/types.h>
+#include <excircles/memorydisplay.h>
+
+// Pixels are converted once when drawn and stored exactly as the display
+// takes them (see DisplayDevice::GetPixelFormat()). Flush() sends the
+// band of rows changed since the last flush; full rows are contiguous in
+// memory so the band goes out with a single WriteRaw() straight from the
+// framebuffer, nothing is copied or repacked.
+class NativeFrameBuffer : public MemoryDisplayDevice
+{
+public:
+    NativeFrameBuffer(DisplayDevice *_display);
+    ~NativeFrameBuffer(void);
+
+    DisplayPixelFormat GetPixelFormat(void) const { return format; }
+    void WriteRaw(const u8 *_data, unsigned _length);
+
+    // direct access in the wire format, report changes with MarkDirty()
+    u8 *GetBuffer(void) { return buffer; }
+
+    // sends whole rows, the band of rows changed since the last flush
+    void Flush(void);
+
+protected:
+    void StorePixels(u8 *_dst, const u16 *_pixels, unsigned _count);
+    void StoreFill(u8 *_dst, u16 _color, unsigned _count);
+    u16 LoadPixel(const u8 *_src) const;
+
+private:
+    DisplayDevice *display;
+    DisplayPixelFormat format;
+};
+
+#endif // _nativefb_h
@@ -0,0 +1,73 @@
+//
+// panelgroup.h
+//
+// Several display panels driven as one large canvas
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _panelgroup_h
+#define _panelgroup_h
+
+#include <circle/types.h>
+#include <excircles/memorydisplay.h>
+#include <excircles/queueddisplay.h>
+
+#define PANEL_GROUP_MAX_PANELS      4
+
+struct PanelGroupPanel
+{
+    QueuedDisplayDevice *device;
+    // top left corner on the canvas
+    unsigned x;
+    unsigned y;
+};
+
+// A DisplayDevice the size of the whole wall (480x320 for 2x1 ILI9341
+// panels, 480x640 for 2x2) backed by one framebuffer. The panels can be
+// any driver with the QueuedDisplayDevice interface, on any bus type. Flush() cuts the changed
+// area along the panel borders and sends every part to its panel.
+//
+// Panels with an SPIQueue go out asynchronously; the rows of all panels
+// are queued in turns, so panels on different controllers with DMA
+// queues are written at the same time. Panels that share a controller
+// share its queue and take turns, panels without one are written
+// directly. Flush() returns when every panel has its part, so all panels
+// always show the same frame.
+class PanelGroup : public MemoryDisplayDevice
+{
+public:
+    PanelGroup(unsigned _width, unsigned _height);
+    ~PanelGroup(void);
+
+    // _x and _y are where the top left corner of the panel sits on the
+    // canvas, the panel must fit
+    boolean AddPanel(QueuedDisplayDevice *_panel, unsigned _x, unsigned _y);
+
+    // direct access, report changes with MarkDirty()
+    u16 *GetBuffer(void) { return (u16 *)buffer; }
+
+    // send the bounding box of everything changed since the last flush
+    void Flush(void);
+
+private:
+    // keeps the polled queues going while waiting for room
+    void Service(void);
+
+private:
+    PanelGroupPanel panels[PANEL_GROUP_MAX_PANELS];
+    unsigned panelCount;
+};
+
+#endif // _panelgroup_h
@@ -0,0 +1,49 @@
+//
+// pixelconvert.h
+//
+// Pixel format conversion and blending kernels
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _pixelconvert_h
+#define _pixelconvert_h
+
+#include <circle/types.h>
+
+// NEON is used when the compiler targets it (RPi 2/3 builds) and
+// PIXEL_CONVERT_NO_NEON is not defined, the plain C loops otherwise.
+// Source and destination must not overlap unless noted.
+#if (defined(__ARM_NEON__) || defined(__ARM_NEON)) && ! defined(PIXEL_CONVERT_NO_NEON)
+#define PIXEL_CONVERT_NEON
+#endif
+
+class PixelConvert
+{
+public:
+    // 0x00RRGGBB to RGB565
+    static void RGB888ToRGB565(u16 *_dst, const u32 *_src, unsigned _count);
+    // 0x00RRGGBB to three bytes per pixel holding 6 bits each (SSD1351)
+    static void RGB888ToRGB666(u8 *_dst, const u32 *_src, unsigned _count);
+    // swap bytes of RGB565 pixels, _dst may equal _src
+    static void SwapRGB565(u16 *_dst, const u16 *_src, unsigned _count);
+    // blend _fg over _bg with _alpha from 0 (_bg) to 32 (_fg), _dst may
+    // equal either source
+    static void BlendRGB565(u16 *_dst, const u16 *_fg, const u16 *_bg,
+                            unsigned _alpha, unsigned _count);
+
+    static const char *GetImplementation(void);
+};
+
+#endif // _pixelconvert_h
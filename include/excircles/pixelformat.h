@@ -0,0 +1,165 @@
+//
+// pixelformat.h
+//
+// Pixel format traits for packing RGB565 pixels into wire formats
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _pixelformat_h
+#define _pixelformat_h
+
+#include <circle/types.h>
+
+// Every traits type knows how many bytes a pixel takes and how to store
+// and load one RGB565 pixel. The loops below are instantiated per format,
+// so each driver gets its packing fully inlined without a runtime switch.
+
+// big endian RGB565, high byte first
+struct PixelFormatRGB565
+{
+    enum { BytesPerPixel = 2 };
+
+    static inline void Store(u8 *_dst, u16 _color)
+    {
+        _dst[0] = _color >> 8;
+        _dst[1] = _color & 0xFF;
+    }
+
+    static inline u16 Load(const u8 *_src)
+    {
+        return (_src[0] << 8) | _src[1];
+    }
+};
+
+// 6 bits per channel in the low bits of each byte, red first, 5 bit
+// channels are widened by repeating their top bit
+struct PixelFormatRGB666
+{
+    enum { BytesPerPixel = 3 };
+
+    static inline void Store(u8 *_dst, u16 _color)
+    {
+        _dst[0] = ((_color >> 10) & 0x3E) | (_color >> 15);
+        _dst[1] = (_color >> 5) & 0x3F;
+        _dst[2] = ((_color << 1) & 0x3E) | ((_color >> 4) & 0x01);
+    }
+
+    static inline u16 Load(const u8 *_src)
+    {
+        return ((_src[0] & 0x3E) << 10) | ((_src[1] & 0x3F) << 5) | ((_src[2] & 0x3E) >> 1);
+    }
+};
+
+// 8 bits per channel, red first
+struct PixelFormatRGB888
+{
+    enum { BytesPerPixel = 3 };
+
+    static inline void Store(u8 *_dst, u16 _color)
+    {
+        _dst[0] = ((_color >> 8) & 0xF8) | (_color >> 13);
+        _dst[1] = ((_color >> 3) & 0xFC) | ((_color >> 9) & 0x03);
+        _dst[2] = ((_color << 3) & 0xF8) | ((_color >> 2) & 0x07);
+    }
+
+    static inline u16 Load(const u8 *_src)
+    {
+        return ((_src[0] & 0xF8) << 8) | ((_src[1] & 0xFC) << 3) | (_src[2] >> 3);
+    }
+};
+
+// palette indices packed into bytes, the leftmost pixel in the most
+// significant bits; Bits is 1, 2, 4 or 8
+template <unsigned Bits>
+struct PixelFormatIndexed
+{
+    enum { PixelsPerByte = 8 / Bits, Mask = (1 << Bits) - 1 };
+
+    static inline unsigned Shift(unsigned _x)
+    {
+        return 8 - Bits - (_x % PixelsPerByte) * Bits;
+    }
+
+    static inline u8 Get(const u8 *_row, unsigned _x)
+    {
+        return (_row[_x / PixelsPerByte] >> Shift(_x)) & Mask;
+    }
+
+    static inline void Set(u8 *_row, unsigned _x, u8 _index)
+    {
+        u8 *p = &_row[_x / PixelsPerByte];
+        *p = (u8)((*p & ~(Mask << Shift(_x))) | ((_index & Mask) << Shift(_x)));
+    }
+};
+
+template <class Format>
+static inline void PackPixels(u8 *_dst, const u16 *_src, unsigned _count)
+{
+    for (unsigned i = 0; i < _count; i++) {
+        Format::Store(_dst, _src[i]);
+        _dst += Format::BytesPerPixel;
+    }
+}
+
+// every pixel twice, for pixel doubling straight into the wire format
+template <class Format>
+static inline void PackPixelsDoubled(u8 *_dst, const u16 *_src, unsigned _count)
+{
+    for (unsigned i = 0; i < _count; i++) {
+        Format::Store(_dst, _src[i]);
+        for (unsigned k = 0; k < Format::BytesPerPixel; k++) {
+            _dst[Format::BytesPerPixel + k] = _dst[k];
+        }
+        _dst += 2 * Format::BytesPerPixel;
+    }
+}
+
+template <class Format>
+static inline void PackFill(u8 *_dst, u16 _color, unsigned _count)
+{
+    u8 pixel[Format::BytesPerPixel];
+    Format::Store(pixel, _color);
+    for (unsigned i = 0; i < _count; i++) {
+        for (unsigned k = 0; k < Format::BytesPerPixel; k++) {
+            *_dst++ = pixel[k];
+        }
+    }
+}
+
+template <class Format>
+static inline void UnpackPixels(u16 *_dst, const u8 *_src, unsigned _count)
+{
+    for (unsigned i = 0; i < _count; i++) {
+        _dst[i] = Format::Load(_src);
+        _src += Format::BytesPerPixel;
+    }
+}
+
+// _count pixels of a row starting at pixel _x through a palette that
+// holds its colors in the wire format, so each pixel is one lookup and
+// a copy
+template <class Format, class Indexed>
+static inline void ExpandIndexed(u8 *_dst, const u8 *_row, unsigned _x, unsigned _count,
+                                 const u8 *_palette)
+{
+    for (unsigned i = 0; i < _count; i++) {
+        const u8 *color = &_palette[Indexed::Get(_row, _x + i) * Format::BytesPerPixel];
+        for (unsigned k = 0; k < Format::BytesPerPixel; k++) {
+            *_dst++ = color[k];
+        }
+    }
+}
+
+#endif // _pixelformat_h
@@ -0,0 +1,57 @@
+//
+// queueddisplay.h
+//
+// Common interface of the display drivers that can queue their transfers
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _queueddisplay_h
+#define _queueddisplay_h
+
+#include <circle/types.h>
+#include <excircles/display.h>
+#include <excircles/spiqueue.h>
+
+// A DisplayDevice that can also put its transfers on an SPIQueue, no
+// matter which bus type the driver was instantiated for. Without a queue
+// only the blocking calls of DisplayDevice work.
+//
+// The async calls queue the transfers and return at once, FALSE when the
+// queue is full. _callback runs when the window is set or the pixels are
+// out, in interrupt context with a DMA queue (see SPIQueueCallback); the
+// pixels must stay put until then. Do not mix in the blocking calls while
+// async ones are pending.
+class QueuedDisplayDevice : public DisplayDevice
+{
+public:
+    QueuedDisplayDevice(unsigned _width, unsigned _height)
+        : DisplayDevice(_width, _height),
+          queue(0)
+    {
+    }
+
+    void SetQueue(SPIQueue *_queue) { queue = _queue; }
+    SPIQueue *GetQueue(void) const { return queue; }
+
+    virtual boolean SetXYAsync(unsigned _x0, unsigned _x1, unsigned _y0, unsigned _y1,
+                               SPIQueueCallback *_callback = 0, void *_param = 0) = 0;
+    virtual boolean WritePixelsAsync(const u16 *_pixels, unsigned _count,
+                                     SPIQueueCallback *_callback = 0, void *_param = 0) = 0;
+
+protected:
+    SPIQueue *queue;
+};
+
+#endif // _queueddisplay_h
@@ -0,0 +1,70 @@
+//
+// readout.h
+//
+// Numeric readout widget that redraws only the changed character cells
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _readout_h
+#define _readout_h
+
+#include <circle/chargenerator.h>
+#include <circle/types.h>
+#include <excircles/display.h>
+
+#define READOUT_MAX_CELLS           16
+// fills all cells when a value does not fit
+#define READOUT_OVERFLOW_GLYPH      '#'
+
+class ReadoutWidget
+{
+public:
+    ReadoutWidget(DisplayDevice *_display, unsigned _x, unsigned _y, unsigned _cells);
+    ~ReadoutWidget(void);
+
+    void SetColor(u16 _fg, u16 _bg);
+    // text is right aligned and padded with spaces to the number of cells
+    void SetText(const char *_text);
+    // _decimals digits, at most READOUT_MAX_CELLS - 2, are placed after the
+    // decimal point; a value that needs more cells than the widget has is
+    // shown as READOUT_OVERFLOW_GLYPH in every cell
+    void SetValue(int _value, unsigned _decimals = 0);
+    // force a full repaint on the next update (e.g. after the screen was cleared)
+    void Invalidate(void);
+
+    // pixel bytes sent to the display so far
+    unsigned GetBytesSent(void) const { return bytesSent; }
+
+private:
+    void DrawCell(unsigned _cell, char _glyph);
+
+private:
+    DisplayDevice *display;
+    CCharGenerator font;
+    unsigned x;
+    unsigned y;
+    unsigned cells;
+    u16 fg;
+    u16 bg;
+    // what is currently on the screen for each cell
+    char shownGlyph[READOUT_MAX_CELLS];
+    u16 shownFg[READOUT_MAX_CELLS];
+    u16 shownBg[READOUT_MAX_CELLS];
+    boolean shownValid[READOUT_MAX_CELLS];
+    u16 *cellBuffer;
+    unsigned bytesSent;
+};
+
+#endif // _readout_h
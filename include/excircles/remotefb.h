@@ -0,0 +1,125 @@
+//
+// remotefb.h
+//
+// Receiver for compressed rectangle updates sent by a host over a serial line
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _remotefb_h
+#define _remotefb_h
+
+#include <circle/device.h>
+#include <circle/types.h>
+#include <excircles/display.h>
+
+// Packet layout (all 16 bit values are little endian), as sent by
+// tools/remotefb.py:
+//
+//   header   'R' 'F' type seq x y width height length         (14 bytes)
+//   payload  length bytes
+//   crc      CRC-16/XMODEM of everything from type to the end of the payload
+//
+// The payload of a rectangle update holds width * height pixels in scan
+// order, encoded as
+//
+//   RAW      RGB565 pixels
+//   RLE      runs as in RLEBitmap: 0x00..0x7F  n + 1 literal pixels follow
+//                                  0x80..0xFF  (n & 0x7F) + 1 copies of the
+//                                              following pixel
+//   DELTA    runs against what is on the display:
+//                                  0x00..0x3F  n + 1 literal pixels follow
+//                                  0x40..0x7F  (n & 0x3F) + 1 copies of the
+//                                              following pixel
+//                                  0x80..0xBF  (n & 0x3F) + 1 pixels stay
+//
+// FRAME marks the end of a frame and INFO asks for the display size; both
+// come without a rectangle and payload. Every packet is answered with
+//
+//   0x16 status seq                                              (3 bytes)
+//
+// where status is 0x06 (done) or 0x15 (rejected, send it again). INFO is
+// answered with 0x16 'I' seq width height max-payload instead. Log
+// messages may share the line, they never contain 0x16.
+#define REMOTE_FB_HEADER_SIZE       14
+#define REMOTE_FB_MAX_PAYLOAD       4096
+
+#define REMOTE_FB_RAW               0
+#define REMOTE_FB_RLE               1
+#define REMOTE_FB_DELTA             2
+#define REMOTE_FB_FRAME             3
+#define REMOTE_FB_INFO              4
+
+#define REMOTE_FB_REPLY             0x16
+#define REMOTE_FB_ACK               0x06
+#define REMOTE_FB_NAK               0x15
+#define REMOTE_FB_REPLY_INFO        'I'
+
+// microseconds of silence after which a partial packet is dropped
+#define REMOTE_FB_TIMEOUT           100000
+
+// Reads packets from _serial, usually a CSerialDevice in interrupt mode so
+// that no bytes are lost while a rectangle is drawn, and decodes them
+// straight into windows of _display. A packet is checked completely
+// before anything is drawn; the host sends the next one when the answer
+// to the last came in, which also keeps the receive buffer from
+// overflowing at high baud rates.
+class RemoteFramebuffer
+{
+public:
+    RemoteFramebuffer(CDevice *_serial, DisplayDevice *_display);
+    ~RemoteFramebuffer(void);
+    boolean Initialize(void);
+
+    // handles what arrived since the last call, call it often
+    void Update(void);
+
+    unsigned GetFrames(void) const { return frames; }
+    unsigned GetPackets(void) const { return packets; }
+    // bad packets and receive errors
+    unsigned GetErrors(void) const { return errors; }
+
+private:
+    void Receive(u8 _byte);
+    void Process(void);
+    void Reply(u8 _status);
+    boolean DecodeRaw(const u8 *_data, unsigned _length);
+    boolean DecodeRLE(const u8 *_data, unsigned _length);
+    boolean DecodeDelta(const u8 *_data, unsigned _length);
+    // _count pixels, or copies of _color without _pixels, at the cursor
+    boolean Emit(const u8 *_pixels, u16 _color, unsigned _count);
+    boolean Skip(unsigned _count);
+
+private:
+    CDevice *serial;
+    DisplayDevice *display;
+    u8 *packet;
+    unsigned received;
+    unsigned lastByte;
+
+    // rectangle being decoded, the cursor and the pixels left in the
+    // current display window
+    unsigned rectX;
+    unsigned rectY;
+    unsigned rectWidth;
+    unsigned rectPixels;
+    unsigned position;
+    unsigned windowLeft;
+
+    unsigned frames;
+    unsigned packets;
+    unsigned errors;
+};
+
+#endif // _remotefb_h
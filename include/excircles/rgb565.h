@@ -0,0 +1,48 @@
+//
+// rgb565.h
+//
+// RGB565 color helpers
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _rgb565_h
+#define _rgb565_h
+
+#include <circle/types.h>
+
+// green goes to the upper half word, red and blue stay in the lower one,
+// leaving enough headroom between the fields for one multiply per pixel
+#define RGB565_SPREAD_MASK          0x07E0F81F
+
+static inline u16 RGB565(unsigned _r, unsigned _g, unsigned _b)
+{
+    return ((_r & 0xF8) << 8) | ((_g & 0xFC) << 3) | (_b >> 3);
+}
+
+static inline u16 RGB888ToRGB565(u32 _color)
+{
+    return RGB565((_color >> 16) & 0xFF, (_color >> 8) & 0xFF, _color & 0xFF);
+}
+
+// blend _fg over _bg, _alpha ranges from 0 (_bg) to 32 (_fg)
+static inline u16 Blend565(u16 _fg, u16 _bg, unsigned _alpha)
+{
+    u32 fg = (_fg | ((u32)_fg << 16)) & RGB565_SPREAD_MASK;
+    u32 bg = (_bg | ((u32)_bg << 16)) & RGB565_SPREAD_MASK;
+    u32 result = ((((fg - bg) * _alpha) >> 5) + bg) & RGB565_SPREAD_MASK;
+    return (u16)(result | (result >> 16));
+}
+
+#endif // _rgb565_h
@@ -0,0 +1,65 @@
+//
+// rlebitmap.h
+//
+// Run-length encoded RGB565 bitmaps streamed to a display
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _rlebitmap_h
+#define _rlebitmap_h
+
+#include <circle/types.h>
+#include <excircles/display.h>
+
+// Stream layout (all 16 bit values are little endian), as produced by
+// tools/rle565.py:
+//
+//   header   'R' '5' width height flags reserved key     (10 bytes)
+//   runs     0x00..0x7F  n + 1 literal pixels follow
+//            0x80..0xFF  (n & 0x7F) + 1 copies of the following pixel
+//
+// Runs never cross a row boundary. With RLE_FLAG_TRANSPARENT set, repeat
+// runs of the key color are skipped and leave the display untouched.
+#define RLE_HEADER_SIZE             10
+#define RLE_FLAG_TRANSPARENT        0x01
+
+// repeat runs at least this long go through the display's fill path
+#define RLE_FILL_THRESHOLD          8
+
+class RLEBitmap
+{
+public:
+    RLEBitmap(const u8 *_data, unsigned _size);
+    ~RLEBitmap(void);
+
+    boolean IsValid(void) const { return valid; }
+    unsigned GetWidth(void) const { return width; }
+    unsigned GetHeight(void) const { return height; }
+    boolean IsTransparent(void) const { return (flags & RLE_FLAG_TRANSPARENT) != 0; }
+
+    // the bitmap must fit onto the display at the given position
+    void Draw(DisplayDevice *_display, unsigned _x, unsigned _y) const;
+
+private:
+    const u8 *data;
+    unsigned size;
+    boolean valid;
+    unsigned width;
+    unsigned height;
+    unsigned flags;
+    u16 key;
+};
+
+#endif // _rlebitmap_h
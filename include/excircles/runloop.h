@@ -0,0 +1,108 @@
+//
+// runloop.h
+//
+// Tickless event loop for timers, GPIO interrupts and completions
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _runloop_h
+#define _runloop_h
+
+#include <circle/gpiopin.h>
+#include <circle/interrupt.h>
+#include <circle/timer.h>
+#include <circle/types.h>
+#include <circle/usertimer.h>
+
+#define RUNLOOP_MAX_TIMERS          8
+#define RUNLOOP_MAX_EVENTS          8
+
+typedef void RunLoopHandler(void *_param);
+
+struct RunLoopTimer
+{
+    boolean used;
+    // CTimer::GetClockTicks() value the handler is due at
+    unsigned deadline;
+    // microseconds, 0 for a one shot timer
+    unsigned period;
+    RunLoopHandler *handler;
+    void *param;
+};
+
+struct RunLoopEvent
+{
+    boolean used;
+    volatile boolean pending;
+    RunLoopHandler *handler;
+    void *param;
+};
+
+// Handlers always run from the loop, never from interrupt context, so they
+// may use the devices freely. Interrupts only mark their event pending.
+// Between events the core sleeps in WFI; a CUserTimer wakes it up right at
+// the next timer deadline instead of on the next scheduler tick.
+//
+// Deadlines are kept in CTimer clock ticks and a periodic timer moves its
+// deadline by exactly one period, so the rate does not drift with the
+// time the handlers take. A timer that fell more than a period behind
+// skips the lost periods instead of firing back to back.
+class RunLoop
+{
+public:
+    RunLoop(CInterruptSystem *_interrupt);
+    ~RunLoop(void);
+    boolean Initialize(void);
+
+    // first call _period microseconds from now; 0 when there is no room
+    RunLoopTimer *AddTimer(unsigned _period, RunLoopHandler *_handler, void *_param = 0,
+                           boolean _periodic = TRUE);
+    void RemoveTimer(RunLoopTimer *_timer);
+
+    // _handler runs once for all the Signal() calls since it last ran
+    RunLoopEvent *AddEvent(RunLoopHandler *_handler, void *_param = 0);
+    void RemoveEvent(RunLoopEvent *_event);
+    // safe from interrupt context
+    static void Signal(RunLoopEvent *_event);
+    // fits SPIQueueCallback and similar completion routines, _param is the
+    // event
+    static void Completion(boolean _ok, void *_param);
+
+    // _pin must have been created with the CGPIOManager
+    RunLoopEvent *AddGPIOSource(CGPIOPin *_pin, TGPIOInterrupt _trigger,
+                                RunLoopHandler *_handler, void *_param = 0);
+
+    // dispatches until Stop() is called from a handler
+    void Run(void);
+    void Stop(void) { stopped = TRUE; }
+    // dispatches what is due, or sleeps until something is
+    void RunOnce(void);
+
+private:
+    // FALSE when nothing was due
+    boolean Dispatch(void);
+    // microseconds to the next deadline, ~0 without timers
+    unsigned GetTimeout(void) const;
+    static void GPIOInterruptHandler(void *_param);
+    static void WakeUp(CUserTimer *_userTimer, void *_param);
+
+private:
+    CUserTimer userTimer;
+    RunLoopTimer timers[RUNLOOP_MAX_TIMERS];
+    RunLoopEvent events[RUNLOOP_MAX_EVENTS];
+    volatile boolean stopped;
+};
+
+#endif // _runloop_h
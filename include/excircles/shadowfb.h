@@ -0,0 +1,107 @@
+//
+// shadowfb.h
+//
+// RAM shadow framebuffer with dirty rectangle tracking
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _shadowfb_h
+#define _shadowfb_h
+
+#include <circle/types.h>
+#include <excircles/memorydisplay.h>
+
+#define SHADOWFB_MAX_DIRTY_RECTS    32
+// cost of setting up a display window expressed in pixels sent
+#define SHADOWFB_WINDOW_COST        64
+// pixels per row covered by one hash in ShadowFBFlushHashDiff mode
+#define SHADOWFB_HASH_SEGMENT       32
+// in interlaced mode smaller changes are still sent in one go
+#define SHADOWFB_INTERLACE_MIN_PIXELS 16384
+
+enum ShadowFBFlushMode
+{
+    // send the areas drawn to since the last flush
+    ShadowFBFlushDirtyRects,
+    // send row segments whose content hash changed since the last flush,
+    // for renderers that redraw the whole frame every time
+    ShadowFBFlushHashDiff
+};
+
+// inclusive corners
+struct DirtyRect
+{
+    unsigned x0;
+    unsigned y0;
+    unsigned x1;
+    unsigned y1;
+};
+
+// Everything drawn through the DisplayDevice interface lands in memory
+// and only records which areas changed. Flush() merges the changed areas
+// where one bigger window is cheaper than several small ones and sends
+// the result to the display.
+class ShadowFrameBuffer : public MemoryDisplayDevice
+{
+public:
+    ShadowFrameBuffer(DisplayDevice *_display);
+    ~ShadowFrameBuffer(void);
+
+    // direct access, report changes with MarkDirty()
+    u16 *GetBuffer(void) { return (u16 *)buffer; }
+
+    void SetWindowCost(unsigned _pixels);
+    boolean SetFlushMode(ShadowFBFlushMode _mode);
+    // Send only every other row of big changes, even rows on one flush and
+    // odd rows on the next, one window per row. Changes below _minPixels
+    // and rows left over from the previous flush are sent progressively,
+    // so a picture that stops moving is complete after the next flush.
+    void SetInterlaced(boolean _interlaced, unsigned _minPixels = SHADOWFB_INTERLACE_MIN_PIXELS);
+    void Flush(void);
+
+    // windows and pixels sent by the last Flush()
+    unsigned GetFlushedWindows(void) const { return flushedWindows; }
+    unsigned GetFlushedPixels(void) const { return flushedPixels; }
+
+protected:
+    // keeps a list of rectangles instead of the bounding box
+    void AddDirty(unsigned _x0, unsigned _y0, unsigned _x1, unsigned _y1);
+    void MergeDirty(void);
+    void DiffHashes(void);
+    void SendRect(const DirtyRect &_rect);
+    void SendField(const DirtyRect &_rect, unsigned _field);
+
+protected:
+    DisplayDevice *display;
+
+    DirtyRect dirtyRects[SHADOWFB_MAX_DIRTY_RECTS];
+    unsigned dirtyCount;
+    unsigned windowCost;
+    ShadowFBFlushMode flushMode;
+    // one hash per row segment, as last sent to the display
+    u32 *hashes;
+    unsigned hashSegments;
+    boolean hashesValid;
+    // rows of the other field still owed from the last interlaced flush
+    boolean interlaced;
+    unsigned interlaceMinPixels;
+    unsigned field;
+    DirtyRect pending[SHADOWFB_MAX_DIRTY_RECTS];
+    unsigned pendingCount;
+    unsigned flushedWindows;
+    unsigned flushedPixels;
+};
+
+#endif // _shadowfb_h
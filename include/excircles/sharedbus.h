@@ -0,0 +1,114 @@
+//
+// sharedbus.h
+//
+// Display on a SPI bus shared with a touch controller
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _sharedbus_h
+#define _sharedbus_h
+
+#include <circle/types.h>
+#include <excircles/display.h>
+#include <excircles/spibus.h>
+#include <excircles/tsc2046.h>
+
+// pixels sent between two checks for a due touch sample
+#define SHARED_BUS_CHUNK_PIXELS     2048
+// touch events held back while pixels are going out
+#define SHARED_BUS_MAX_EVENTS       8
+
+// Sits in front of a display that shares its SPI bus with a TSC2046 and
+// is used in place of the display. Pixel writes are cut into chunks of
+// at most _chunkPixels and a touch sample is taken between two chunks
+// whenever one is due, so a long flush delays a sample by at most one
+// chunk. The controller stays in memory write mode while the touch chip
+// select is active, the window carries on after the sample.
+//
+// The bus runs at _displayClock, as the display driver set it up, and is
+// switched to _touchClock for each sample; the TSC2046 converts too
+// slowly at display rates.
+//
+// The touch events go to the handler registered here, not with the touch
+// device, which must have none. They are held back until Update() is
+// called with no write in progress, so the handler may draw. Successive
+// moves are merged while they wait. Call Update() from the main loop, it
+// also samples the touch screen when no pixels are going out.
+//
+// Only one instance may exist, the touch device reports to it through a
+// plain function.
+class SharedBusDisplay : public DisplayDevice
+{
+public:
+    // _samplePeriod in microseconds, the clocks in Hz
+    SharedBusDisplay(DisplayDevice *_display, TSC2046Device *_touch, SPIBus _bus,
+                     unsigned _displayClock, unsigned _touchClock, unsigned _samplePeriod,
+                     unsigned _chunkPixels = SHARED_BUS_CHUNK_PIXELS);
+    ~SharedBusDisplay(void);
+
+    void SetXY(unsigned _x0, unsigned _x1, unsigned _y0, unsigned _y1);
+    void WritePixels(const u16 *_pixels, unsigned _count);
+    void FillPixels(u16 _color, unsigned _count);
+    DisplayPixelFormat GetPixelFormat(void) const { return display->GetPixelFormat(); }
+    void WriteRaw(const u8 *_data, unsigned _length);
+
+    void RegisterEventHandler(TSC2046EventHandler *_eventHandler);
+    // samples the touch screen if it is due and reports the events
+    void Update(void);
+
+    // longest time a due sample had to wait, in microseconds
+    unsigned GetMaxLatency(void) const { return maxLatency; }
+    unsigned GetSamples(void) const { return samples; }
+    // events lost because too many were waiting
+    unsigned GetLostEvents(void) const { return lostEvents; }
+    void ResetStats(void);
+
+private:
+    // samples the touch screen if it is due
+    void Poll(void);
+    void Sample(void);
+    static void TouchEventHandler(TSC2046Event _event, unsigned _id,
+                                  unsigned _posX, unsigned _posY);
+
+private:
+    struct Event
+    {
+        TSC2046Event event;
+        unsigned id;
+        unsigned posX;
+        unsigned posY;
+    };
+
+    DisplayDevice *display;
+    TSC2046Device *touch;
+    SPIBus bus;
+    unsigned displayClock;
+    unsigned touchClock;
+    unsigned samplePeriod;
+    unsigned chunkPixels;
+    // CTimer::GetClockTicks() at the next due sample
+    unsigned deadline;
+    unsigned maxLatency;
+    unsigned samples;
+
+    TSC2046EventHandler *eventHandler;
+    Event events[SHARED_BUS_MAX_EVENTS];
+    unsigned eventCount;
+    unsigned lostEvents;
+
+    static SharedBusDisplay *s_pThis;
+};
+
+#endif // _sharedbus_h
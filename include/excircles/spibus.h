@@ -0,0 +1,144 @@
+//
+// spibus.h
+//
+// Either of the SPI controllers behind one interface
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _spibus_h
+#define _spibus_h
+
+#include <circle/spimaster.h>
+#include <circle/spimasteraux.h>
+#include <circle/types.h>
+#include <assert.h>
+
+// The SPI drivers are templates over a bus: any copyable class with the
+// Write() and WriteRead() calls below. SPIBus, which the plain driver
+// names use, is built implicitly from a CSPIMaster (SPI0) or a
+// CSPIMasterAUX (SPI1) pointer. The controller is picked per device
+// instance, so for example the touch controller can sit on SPI1 while the
+// display owns SPI0 and both buses run at the same time.
+class SPIBus
+{
+public:
+    // no controller, for owners that may not need one
+    SPIBus(void)
+        : SPIMaster(0),
+          SPIMasterAUX(0)
+    {
+    }
+
+    SPIBus(CSPIMaster *_SPIMaster)
+        : SPIMaster(_SPIMaster),
+          SPIMasterAUX(0)
+    {
+        assert(SPIMaster != 0);
+    }
+
+    SPIBus(CSPIMasterAUX *_SPIMasterAUX)
+        : SPIMaster(0),
+          SPIMasterAUX(_SPIMasterAUX)
+    {
+        assert(SPIMasterAUX != 0);
+    }
+
+    boolean IsValid(void) const { return SPIMaster != 0 || SPIMasterAUX != 0; }
+    boolean IsAUX(void) const { return SPIMasterAUX != 0; }
+
+    void SetClock(unsigned _clockSpeed)
+    {
+        assert(IsValid());
+        if (SPIMaster != 0) {
+            SPIMaster->SetClock(_clockSpeed);
+        } else {
+            SPIMasterAUX->SetClock(_clockSpeed);
+        }
+    }
+
+    // return the number of bytes transferred or < 0 on failure, like the
+    // controller classes do
+    int Write(unsigned _cs, const void *_buffer, unsigned _count)
+    {
+        assert(IsValid());
+        if (SPIMaster != 0) {
+            return SPIMaster->Write(_cs, _buffer, _count);
+        }
+        return SPIMasterAUX->Write(_cs, _buffer, _count);
+    }
+
+    int WriteRead(unsigned _cs, const void *_tx, void *_rx, unsigned _count)
+    {
+        assert(IsValid());
+        if (SPIMaster != 0) {
+            return SPIMaster->WriteRead(_cs, _tx, _rx, _count);
+        }
+        return SPIMasterAUX->WriteRead(_cs, _tx, _rx, _count);
+    }
+
+private:
+    CSPIMaster *SPIMaster;
+    CSPIMasterAUX *SPIMasterAUX;
+};
+
+// Handles for one controller type, for the driver templates: the calls go
+// straight to the controller with no test in between.
+class SPIMasterBus
+{
+public:
+    SPIMasterBus(CSPIMaster *_SPIMaster)
+        : SPIMaster(_SPIMaster)
+    {
+        assert(SPIMaster != 0);
+    }
+
+    void SetClock(unsigned _clockSpeed) { SPIMaster->SetClock(_clockSpeed); }
+    int Write(unsigned _cs, const void *_buffer, unsigned _count)
+    {
+        return SPIMaster->Write(_cs, _buffer, _count);
+    }
+    int WriteRead(unsigned _cs, const void *_tx, void *_rx, unsigned _count)
+    {
+        return SPIMaster->WriteRead(_cs, _tx, _rx, _count);
+    }
+
+private:
+    CSPIMaster *SPIMaster;
+};
+
+class SPIMasterAUXBus
+{
+public:
+    SPIMasterAUXBus(CSPIMasterAUX *_SPIMasterAUX)
+        : SPIMasterAUX(_SPIMasterAUX)
+    {
+        assert(SPIMasterAUX != 0);
+    }
+
+    void SetClock(unsigned _clockSpeed) { SPIMasterAUX->SetClock(_clockSpeed); }
+    int Write(unsigned _cs, const void *_buffer, unsigned _count)
+    {
+        return SPIMasterAUX->Write(_cs, _buffer, _count);
+    }
+    int WriteRead(unsigned _cs, const void *_tx, void *_rx, unsigned _count)
+    {
+        return SPIMasterAUX->WriteRead(_cs, _tx, _rx, _count);
+    }
+
+private:
+    CSPIMasterAUX *SPIMasterAUX;
+};
+
+#endif // _spibus_h
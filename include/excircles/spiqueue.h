@@ -0,0 +1,230 @@
+//
+// spiqueue.h
+//
+// Queue of SPI transfers that run in the background
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _spiqueue_h
+#define _spiqueue_h
+
+#include <circle/gpiopin.h>
+#include <circle/spimasterdma.h>
+#include <circle/synchronize.h>
+#include <circle/types.h>
+#include <excircles/spibus.h>
+#include <excircles/spscqueue.h>
+
+// transfers waiting on the bus, plus one
+#define SPIQUEUE_SIZE               33
+// bytes of a transfer that are copied into the queue
+#define SPIQUEUE_INLINE_SIZE        40
+// bytes that go out in one bus transfer
+#define SPIQUEUE_CHUNK_SIZE         4096
+// alignment of the bounce buffers, DMA works on whole cache lines
+#define SPIQUEUE_ALIGN              DATA_CACHE_LINE_LENGTH_MAX
+
+// _ok is FALSE when the bus reported an error. With a DMA queue this runs
+// in the DMA completion interrupt. It must not queue transfers itself:
+// the queue takes one producer, and that is the task context.
+typedef void SPIQueueCallback(boolean _ok, void *_param);
+// converts _count host order RGB565 pixels into the wire format
+typedef void SPIQueuePackFunction(u8 *_dst, const u16 *_src, unsigned _count);
+
+struct SPIQueueTransfer
+{
+    unsigned cs;
+    // data/command pin set before the transfer, if any
+    CGPIOPin *dc;
+    unsigned dcLevel;
+    // bytes sent as they are, or 0 for inline data and pixels
+    const u8 *data;
+    // pixels packed chunk by chunk, or 0
+    const u16 *pixels;
+    SPIQueuePackFunction *pack;
+    unsigned bytesPerPixel;
+    // bytes, or pixels for a pixel transfer
+    unsigned length;
+    // receives length bytes, inline transfers only
+    u8 *rx;
+    u8 inlineData[SPIQUEUE_INLINE_SIZE];
+    SPIQueueCallback *callback;
+    void *param;
+};
+
+// Queued transfers run in submission order, each one finishes through its
+// callback. With a CSPIMasterDMA the queue runs from the DMA completion
+// interrupt and the callbacks are called from there; with a polled SPI
+// master Poll() moves one chunk at a time and calls the callbacks, so
+// the main loop stays responsive while long pixel writes are on the way.
+// Several devices on the same bus can share one queue, their transfers
+// simply take turns.
+//
+// Only the task context may call the Write*() functions. A callback that
+// wants more transfers signals the task, e.g. with RunLoop::Completion(),
+// and the task queues them.
+//
+// Data and pixels passed by pointer belong to the queue until their
+// callback was called.
+class SPIQueue
+{
+public:
+    // polled on either controller
+    SPIQueue(SPIBus _bus);
+    // DMA, SPI0 only
+    SPIQueue(CSPIMasterDMA *_SPIMasterDMA);
+    ~SPIQueue(void);
+    boolean Initialize(void);
+
+    // all return FALSE when the queue is full
+
+    // _data is copied, _rx gets what came back
+    boolean WriteInline(unsigned _cs, CGPIOPin *_dc, unsigned _dcLevel,
+                        const u8 *_data, unsigned _length, u8 *_rx = 0,
+                        SPIQueueCallback *_callback = 0, void *_param = 0);
+    // _data goes out in place, with DMA it must be cache line aligned
+    boolean WriteBuffer(unsigned _cs, CGPIOPin *_dc, unsigned _dcLevel,
+                        const u8 *_data, unsigned _length,
+                        SPIQueueCallback *_callback = 0, void *_param = 0);
+    // RGB565 _pixels go through _pack, e.g. PackPixels<PixelFormatRGB565>
+    boolean WritePixels(unsigned _cs, CGPIOPin *_dc, unsigned _dcLevel,
+                        const u16 *_pixels, unsigned _count,
+                        SPIQueuePackFunction *_pack, unsigned _bytesPerPixel,
+                        SPIQueueCallback *_callback = 0, void *_param = 0);
+
+    // transfers that still fit
+    unsigned GetFree(void) const { return SPIQUEUE_SIZE - 1 - queue.GetCount(); }
+    boolean IsIdle(void) const { return ! active && queue.IsEmpty(); }
+    // polled bus: sends the next chunk, if any; nothing to do with DMA
+    void Poll(void);
+    // wait until everything queued was sent
+    void Sync(void);
+
+private:
+    boolean Submit(const SPIQueueTransfer &_transfer);
+    // takes the next transfer off the queue, FALSE when there is none
+    boolean Next(void);
+    // next chunk of the current transfer, packed into the bounce buffer
+    // or in place
+    const u8 *Prepare(void);
+    // the chunk on the bus is done
+    void Complete(boolean _ok);
+    // puts the next chunk on a DMA bus
+    void Start(void);
+    static void DMACompletion(boolean _ok, void *_param);
+
+private:
+    SPIBus bus;
+    CSPIMasterDMA *SPIMasterDMA;
+    SPSCQueue<SPIQueueTransfer, SPIQUEUE_SIZE> queue;
+    // the transfer on the bus and how much of it was sent
+    SPIQueueTransfer current;
+    volatile boolean active;
+    // set while a callback runs, queueing from there is a bug
+    volatile boolean inCallback;
+    unsigned offset;
+    // the chunk on the bus, in bytes or pixels, and in bytes
+    unsigned chunk;
+    unsigned chunkBytes;
+    u8 *memory;
+    u8 *txBounce;
+    u8 *rxBounce;
+};
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#include <assert.h>
+#include <coroutine>
+#include <excircles/runloop.h>
+#define SPIQUEUE_COROUTINES
+
+// Pass Completion and the awaiter to an async call, hand the result of the
+// call to SetQueued() and co_await the awaiter: the coroutine gets the
+// status of the transfer once it is done. A call that did not fit the
+// queue resumes right away with FALSE.
+//
+// Completion only records the status and signals an event of _loop, the
+// coroutine is resumed from the loop. So it runs in task context, with a
+// DMA queue too, and may queue the next transfer. An awaiter takes one
+// event of the loop while it exists and is good for one transfer.
+class SPIQueueAwaiter
+{
+public:
+    SPIQueueAwaiter(RunLoop *_loop)
+        : loop(_loop),
+          queued(FALSE),
+          done(FALSE),
+          ok(FALSE)
+    {
+        assert(loop != 0);
+        event = loop->AddEvent(Resume, this);
+        assert(event != 0);
+    }
+
+    ~SPIQueueAwaiter(void)
+    {
+        loop->RemoveEvent(event);
+        event = 0;
+        loop = 0;
+    }
+
+    static void Completion(boolean _ok, void *_param)
+    {
+        SPIQueueAwaiter *awaiter = (SPIQueueAwaiter *)_param;
+        awaiter->ok = _ok;
+        DataMemBarrier();
+        awaiter->done = TRUE;
+        RunLoop::Signal(awaiter->event);
+    }
+
+    // called with the result of the async call
+    void SetQueued(boolean _queued) { queued = _queued; }
+
+    bool await_ready(void) const { return ! queued || done; }
+    bool await_suspend(std::coroutine_handle<> _handle)
+    {
+        // the loop resumes the coroutine, not Completion, so there is no
+        // race with it here
+        handle = _handle;
+        return true;
+    }
+    boolean await_resume(void) const { return queued && ok; }
+
+private:
+    static void Resume(void *_param)
+    {
+        SPIQueueAwaiter *awaiter = (SPIQueueAwaiter *)_param;
+        // the event may also have been signalled before the coroutine got
+        // to co_await, it did not suspend then
+        if (awaiter->done && awaiter->handle) {
+            std::coroutine_handle<> handle = awaiter->handle;
+            awaiter->handle = nullptr;
+            handle.resume();
+        }
+    }
+
+private:
+    RunLoop *loop;
+    RunLoopEvent *event;
+    boolean queued;
+    volatile boolean done;
+    boolean ok;
+    std::coroutine_handle<> handle;
+};
+
+#endif // __has_include(<coroutine>)
+#endif // __cpp_impl_coroutine
+
+#endif // _spiqueue_h
@@ -0,0 +1,82 @@
+//
+// spscqueue.h
+//
+// Lock free single producer, single consumer queue
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _spscqueue_h
+#define _spscqueue_h
+
+#include <circle/synchronize.h>
+#include <circle/types.h>
+
+// One core pushes, one other core pops; neither ever waits for the other.
+// Only the producer writes head and only the consumer writes tail, the
+// barriers order the item accesses against the index updates. Holds
+// Size - 1 items.
+template <class T, unsigned Size>
+class SPSCQueue
+{
+public:
+    SPSCQueue(void)
+        : head(0),
+          tail(0)
+    {
+    }
+
+    // producer side, FALSE when full
+    boolean Push(const T &_item)
+    {
+        unsigned next = (head + 1) % Size;
+        if (next == tail) {
+            return FALSE;
+        }
+
+        items[head] = _item;
+        // the item is complete before the consumer can see it
+        DataMemBarrier();
+        head = next;
+
+        return TRUE;
+    }
+
+    // consumer side, FALSE when empty
+    boolean Pop(T *_item)
+    {
+        if (tail == head) {
+            return FALSE;
+        }
+
+        // the item is read only after head said it is there
+        DataMemBarrier();
+        *_item = items[tail];
+        // and before the producer may overwrite it
+        DataMemBarrier();
+        tail = (tail + 1) % Size;
+
+        return TRUE;
+    }
+
+    boolean IsEmpty(void) const { return head == tail; }
+    unsigned GetCount(void) const { return (head + Size - tail) % Size; }
+
+private:
+    T items[Size];
+    volatile unsigned head;
+    volatile unsigned tail;
+};
+
+#endif // _spscqueue_h
@@ -20,24 +20,42 @@
 #ifndef _ssd1351_h
 #define _ssd1351_h
 
-#include <circle/device.h>
 #include <circle/gpiopin.h>
+#include <circle/logger.h>
+#include <circle/timer.h>
 #include <circle/types.h>
-#ifndef USE_SPI_MASTER_AUX
-#include <circle/spimaster.h>
-#else
-#include <circle/spimasteraux.h>
-#endif
+#include <excircles/pixelformat.h>
+#include <excircles/queueddisplay.h>
+#include <excircles/spibus.h>
+#include <assert.h>
 
-class SSD1351Device : public CDevice
+#define SSD1351_WIDTH               128
+#define SSD1351_HEIGHT              128
+// size of the buffer pixels are packed into before going out over SPI
+#define SSD1351_TX_BUFFER_SIZE      384
+
+// Bus is SPIBus or any other class with its Write() calls, see spibus.h
+template <class Bus>
+class SSD1351DeviceT : public QueuedDisplayDevice
 {
 public:
-	SSD1351Device(CSPIMaster *_SPIMaster, unsigned _cs, unsigned _dc, unsigned _rst);
-	~SSD1351Device(void);
+	SSD1351DeviceT(Bus _bus, unsigned _cs, unsigned _dc, unsigned _rst);
+	~SSD1351DeviceT(void);
 	boolean Initialize(void);
 	void WriteCommand(unsigned _cmd);
 	void WriteData(unsigned _data);
 	void SetXY(unsigned _x0, unsigned _x1, unsigned _y0, unsigned _y1);
+	void WritePixels(const u16 *_pixels, unsigned _count);
+	void FillPixels(u16 _color, unsigned _count);
+	DisplayPixelFormat GetPixelFormat(void) const { return DisplayPixelFormatRGB666; }
+	void WriteRaw(const u8 *_data, unsigned _length);
+
+	// see QueuedDisplayDevice
+	boolean SetXYAsync(unsigned _x0, unsigned _x1, unsigned _y0, unsigned _y1,
+	                   SPIQueueCallback *_callback = 0, void *_param = 0);
+	boolean WritePixelsAsync(const u16 *_pixels, unsigned _count,
+	                         SPIQueueCallback *_callback = 0, void *_param = 0);
+
 	void Paint(unsigned _color);
 	void Clear(void);
     void DrawPixel(unsigned _x, unsigned _y, unsigned _color);
@@ -46,14 +64,351 @@ public:
     void Spectrum(void);
 
 private:
-#ifndef USE_SPI_MASTER_AUX
-	CSPIMaster *SPIMaster;
-#else
-	CSPIMasterAUX *SPIMaster;
-#endif
+    void FillBytes(u8 _b0, u8 _b1, u8 _b2, unsigned _count);
+    void WriteBuffer(unsigned _count);
+
+private:
+	// log source, as in ILI9341DeviceT
+	static const char FromSSD1351[];
+
+	Bus bus;
     unsigned cs;
     CGPIOPin dc;
     CGPIOPin rst;
+    u8 txBuffer[SSD1351_TX_BUFFER_SIZE];
 };
 
+template <class Bus>
+const char SSD1351DeviceT<Bus>::FromSSD1351[] = "ssd1351";
+
+template <class Bus>
+SSD1351DeviceT<Bus>::SSD1351DeviceT(Bus _bus, unsigned _cs, unsigned _dc, unsigned _rst)
+    : QueuedDisplayDevice(SSD1351_WIDTH, SSD1351_HEIGHT),
+      bus(_bus),
+      cs(_cs),
+      dc(_dc, GPIOModeOutput),
+      rst(_rst, GPIOModeOutput)
+{
+}
+
+template <class Bus>
+SSD1351DeviceT<Bus>::~SSD1351DeviceT(void)
+{
+}
+
+template <class Bus>
+boolean SSD1351DeviceT<Bus>::Initialize(void)
+{
+    // perform reset
+    rst.Write(HIGH);
+    CTimer::SimpleMsDelay(1);
+    rst.Write(LOW);
+    CTimer::SimpleMsDelay(1);
+    rst.Write(HIGH);
+    CTimer::SimpleMsDelay(20);
+
+    // initialize
+    WriteCommand(0xFD);
+    WriteData(0x12);
+    WriteCommand(0xFD);
+    WriteData(0xB1);
+    WriteCommand(0xAE);
+    WriteCommand(0xB3);
+    WriteData(0xF1);
+    WriteCommand(0xCA);
+    WriteData(0x7F);
+    WriteCommand(0xA2);
+    WriteData(0x00);
+    WriteCommand(0xA1);
+    WriteData(0x00);
+    WriteCommand(0xA0);
+    //WriteData(0xA0);
+    WriteData(0xB0);
+    WriteCommand(0xB5);
+    WriteData(0x00);
+    WriteCommand(0xAB);
+    WriteData(0x01);
+    WriteCommand(0xB4);
+    WriteData(0xA0);
+    WriteData(0xB5);
+    WriteData(0x55);
+    WriteCommand(0xC1);
+    WriteData(0x8A);
+    WriteData(0x70);
+    WriteData(0x8A);
+    WriteCommand(0xC7);
+    WriteData(0x0F);
+    WriteCommand(0xB9);
+    WriteCommand(0xB1);
+    WriteData(0x32);
+    WriteCommand(0xBB);
+    WriteData(0x07);
+    WriteCommand(0xB2);
+    WriteData(0xa4);
+    WriteData(0x00);
+    WriteData(0x00);
+    WriteCommand(0xB6);
+    WriteData(0x01);
+    WriteCommand(0xBE);
+    WriteData(0x07);
+    WriteCommand(0xA6);
+    WriteCommand(0xAF);
+
+    CLogger::Get()->Write(FromSSD1351, LogNotice, "SSD1351 intialized!");
+    return TRUE;
+}
+
+template <class Bus>
+void SSD1351DeviceT<Bus>::WriteCommand(unsigned _cmd)
+{
+    dc.Write(LOW);
+    u8 cmd = (u8)_cmd;
+    if (bus.Write(cs, &cmd, 1) != 1) {
+        CLogger::Get()->Write(FromSSD1351, LogError, "SPI write error");
+    }
+}
+
+template <class Bus>
+void SSD1351DeviceT<Bus>::WriteData(unsigned _data)
+{
+    dc.Write(HIGH);
+    u8 data = (u8)_data;
+    if (bus.Write(cs, &data, 1) != 1) {
+        CLogger::Get()->Write(FromSSD1351, LogError, "SPI write error");
+    }
+}
+
+template <class Bus>
+void SSD1351DeviceT<Bus>::SetXY(unsigned _x0, unsigned _x1, unsigned _y0, unsigned _y1)
+{
+    // column
+    WriteCommand(0x15);
+    WriteData(_x0);
+    WriteData(_x1);
+    // row
+    WriteCommand(0x75);
+    WriteData(_y0);
+    WriteData(_y1);
+    // write
+    WriteCommand(0x5C);
+}
+
+template <class Bus>
+void SSD1351DeviceT<Bus>::WritePixels(const u16 *_pixels, unsigned _count)
+{
+    while (_count > 0) {
+        unsigned n = _count;
+        if (n > SSD1351_TX_BUFFER_SIZE / 3) {
+            n = SSD1351_TX_BUFFER_SIZE / 3;
+        }
+        PackPixels<PixelFormatRGB666>(txBuffer, _pixels, n);
+        WriteBuffer(3*n);
+        _pixels += n;
+        _count -= n;
+    }
+}
+
+template <class Bus>
+void SSD1351DeviceT<Bus>::FillPixels(u16 _color, unsigned _count)
+{
+    u8 pixel[PixelFormatRGB666::BytesPerPixel];
+    PixelFormatRGB666::Store(pixel, _color);
+    FillBytes(pixel[0], pixel[1], pixel[2], _count);
+}
+
+template <class Bus>
+void SSD1351DeviceT<Bus>::WriteRaw(const u8 *_data, unsigned _length)
+{
+    dc.Write(HIGH);
+    if (bus.Write(cs, _data, _length) != (int)_length) {
+        CLogger::Get()->Write(FromSSD1351, LogError, "SPI write error");
+    }
+}
+
+template <class Bus>
+boolean SSD1351DeviceT<Bus>::SetXYAsync(unsigned _x0, unsigned _x1, unsigned _y0, unsigned _y1,
+                                  SPIQueueCallback *_callback, void *_param)
+{
+    assert(queue != 0);
+    // all or nothing, a half set window would break the next write
+    if (queue->GetFree() < 5) {
+        return FALSE;
+    }
+
+    const u8 column = 0x15;
+    const u8 row = 0x75;
+    const u8 write = 0x5C;
+    u8 x[2] = {(u8)_x0, (u8)_x1};
+    u8 y[2] = {(u8)_y0, (u8)_y1};
+
+    queue->WriteInline(cs, &dc, LOW, &column, 1);
+    queue->WriteInline(cs, &dc, HIGH, x, sizeof(x));
+    queue->WriteInline(cs, &dc, LOW, &row, 1);
+    queue->WriteInline(cs, &dc, HIGH, y, sizeof(y));
+    queue->WriteInline(cs, &dc, LOW, &write, 1, 0, _callback, _param);
+
+    return TRUE;
+}
+
+template <class Bus>
+boolean SSD1351DeviceT<Bus>::WritePixelsAsync(const u16 *_pixels, unsigned _count,
+                                        SPIQueueCallback *_callback, void *_param)
+{
+    assert(queue != 0);
+
+    return queue->WritePixels(cs, &dc, HIGH, _pixels, _count,
+                              PackPixels<PixelFormatRGB666>, PixelFormatRGB666::BytesPerPixel,
+                              _callback, _param);
+}
+
+template <class Bus>
+void SSD1351DeviceT<Bus>::Paint(unsigned _color)
+{
+    SetXY(0, SSD1351_WIDTH-1, 0, SSD1351_HEIGHT-1);
+    FillBytes((_color >> 16) & 0xFF, (_color >> 8) & 0xFF, _color & 0xFF,
+              SSD1351_WIDTH * SSD1351_HEIGHT);
+}
+
+template <class Bus>
+void SSD1351DeviceT<Bus>::Clear(void)
+{
+    Paint(0x000000);
+}
+
+template <class Bus>
+void SSD1351DeviceT<Bus>::FillBytes(u8 _b0, u8 _b1, u8 _b2, unsigned _count)
+{
+    unsigned n = _count;
+    if (n > SSD1351_TX_BUFFER_SIZE / 3) {
+        n = SSD1351_TX_BUFFER_SIZE / 3;
+    }
+    // the buffer content is the same for every chunk
+    for (unsigned i = 0; i < n; i++) {
+        txBuffer[3*i] = _b0;
+        txBuffer[3*i + 1] = _b1;
+        txBuffer[3*i + 2] = _b2;
+    }
+
+    while (_count > 0) {
+        n = _count;
+        if (n > SSD1351_TX_BUFFER_SIZE / 3) {
+            n = SSD1351_TX_BUFFER_SIZE / 3;
+        }
+        WriteBuffer(3*n);
+        _count -= n;
+    }
+}
+
+template <class Bus>
+void SSD1351DeviceT<Bus>::WriteBuffer(unsigned _count)
+{
+    assert(_count <= SSD1351_TX_BUFFER_SIZE);
+    dc.Write(HIGH);
+    if (bus.Write(cs, txBuffer, _count) != (int)_count) {
+        CLogger::Get()->Write(FromSSD1351, LogError, "SPI write error");
+    }
+}
+
+template <class Bus>
+void SSD1351DeviceT<Bus>::DrawPixel(unsigned _x, unsigned _y, unsigned _color)
+{
+    SetXY(_x, _x, _y, _y);
+    WriteData((_color >> 16) & 0xFF);
+    WriteData((_color >> 8) & 0xFF);
+    WriteData(_color & 0xFF);
+}
+
+template <class Bus>
+void SSD1351DeviceT<Bus>::DrawLine(int _x1, int _y1, int _x2, int _y2, int _color)
+{
+    int deltaX = _x2-_x1 >= 0 ? _x2-_x1 : _x1-_x2;
+    int signX  = _x1 < _x2 ? 1 : -1;
+
+    int deltaY = -(_y2-_y1 >= 0 ? _y2-_y1 : _y1-_y2);
+    int signY  = _y1 < _y2 ? 1 : -1;
+
+    int error = deltaX + deltaY;
+
+    while (1) {
+        DrawPixel((unsigned)_x1, (unsigned)_y1, _color);
+
+        if (_x1 == _x2 && _y1 == _y2) {
+            break;
+        }
+
+        int error2 = error + error;
+        if (error2 > deltaY) {
+            error += deltaY;
+            _x1 += signX;
+        }
+
+        if (error2 < deltaX) {
+            error += deltaX;
+            _y1 += signY;
+        }
+    }
+}
+
+template <class Bus>
+void SSD1351DeviceT<Bus>::DrawSquare(unsigned _x, unsigned _y, unsigned _size, unsigned _color)
+{
+    SetXY(_x, _x + _size-1, _y, _y + _size-1);
+    FillBytes((_color >> 16) & 0xFF, (_color >> 8) & 0xFF, _color & 0xFF,
+              _size * _size);
+}
+
+template <class Bus>
+void SSD1351DeviceT<Bus>::Spectrum(void)
+{
+    unsigned i, j;
+    unsigned blue, green, red;
+
+    SetXY(0, SSD1351_WIDTH-1, 0, 37);
+    for (i = 0; i < 128; i++) {
+        WriteData(0xFF); WriteData(0xFF); WriteData(0xFF);
+    }
+    for (i = 0; i < 36; i++) {
+        blue = 0x00;
+        green = 0x00;
+        red = 0x3F;
+        WriteData(0xFF); WriteData(0xFF); WriteData(0xFF);
+        for (j = 0; j < 21; j++) {
+            WriteData(blue); WriteData(green); WriteData(red);
+            green += 3;
+        }
+        for (j = 0; j < 21; j++) {
+            WriteData(blue); WriteData(green); WriteData(red);
+            red -= 3;
+        }
+        for (j = 0; j < 21; j++) {
+            WriteData(blue); WriteData(green); WriteData(red);
+            blue += 3;
+        }
+        for (j = 0; j < 21; j++) {
+            WriteData(blue); WriteData(green); WriteData(red);
+            green -= 3;
+        }
+        for (j = 0; j < 21; j++) {
+            WriteData(blue); WriteData(green); WriteData(red);
+            red += 3;
+        }
+        for (j = 0; j < 21; j++) {
+            WriteData(blue); WriteData(green); WriteData(red);
+            blue -= 3;
+        }
+        WriteData(0xFF); WriteData(0xFF); WriteData(0xFF);
+    }
+    for (i = 0; i < 128; i++) {
+        WriteData(0xFF); WriteData(0xFF); WriteData(0xFF);
+    }
+}
+
+typedef SSD1351DeviceT<SPIBus> SSD1351Device;
+
+// the library instantiates the drivers for its own bus types, other ones
+// like mock buses for host builds are instantiated where they are used
+extern template class SSD1351DeviceT<SPIBus>;
+extern template class SSD1351DeviceT<SPIMasterBus>;
+extern template class SSD1351DeviceT<SPIMasterAUXBus>;
+
 #endif // _ssd1351_h
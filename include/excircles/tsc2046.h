@@ -21,12 +21,15 @@
 #define _tsc2046_h
 
 #include <circle/device.h>
+#include <circle/devicenameservice.h>
+#include <circle/logger.h>
 #include <circle/types.h>
-#ifndef USE_SPI_MASTER_AUX
-#include <circle/spimaster.h>
-#else
-#include <circle/spimasteraux.h>
-#endif
+#include <excircles/spibus.h>
+#include <excircles/spiqueue.h>
+#include <assert.h>
+
+// bytes of one touch sample transfer
+#define TSC2046_SAMPLE_SIZE         36
 
 enum TSC2046Event
 {
@@ -39,32 +42,213 @@ enum TSC2046Event
 typedef void TSC2046EventHandler(TSC2046Event _event, unsigned _id,
                                       unsigned _posX, unsigned _posY);
 
-class TSC2046Device : public CDevice
+// Bus is SPIBus or any other class with its WriteRead() call, see spibus.h
+template <class Bus>
+class TSC2046DeviceT : public CDevice
 {
 public:
-#ifndef USE_SPI_MASTER_AUX
-    TSC2046Device(CSPIMaster *_SPIMaster, unsigned _cs, unsigned _threshold = 400);
-#else
-    CTSC2046Device(CSPIMasterAUX *_SPIMaster, unsigned _cs, unsigned _threshold = 400);
-#endif
-    ~TSC2046Device(void);
+    TSC2046DeviceT(Bus _bus, unsigned _cs, unsigned _threshold = 400);
+    ~TSC2046DeviceT(void);
     boolean Initialize(void);
     // call this about 60 times per second
     void Update(void);
+    void SetQueue(SPIQueue *_queue);
+    // queues the sample transfer on the queue and returns at once, FALSE
+    // when the queue is full or the last update is still pending; events
+    // are reported before _callback runs. Both the event handler and
+    // _callback run where the queue completes the transfer: with a DMA
+    // queue that is the DMA completion interrupt, where they must not
+    // draw, log or queue transfers. Have them record the event and signal
+    // the task, e.g. with RunLoop::Signal().
+    boolean UpdateAsync(SPIQueueCallback *_callback = 0, void *_param = 0);
     void RegisterEventHandler(TSC2046EventHandler *_eventHandler);
 
 private:
-#ifndef USE_SPI_MASTER_AUX
-    CSPIMaster *SPIMaster;
-#else
-    CSPIMasterAUX *SPIMaster;
-#endif
+    void Process(const u8 *_rxBuffer);
+    static void UpdateDone(boolean _ok, void *_param);
+
+private:
+    // members so that every instantiation shares one definition
+    static const char FromTSC2046[];
+    static const u8 TSC2046SampleCommands[TSC2046_SAMPLE_SIZE];
+
+    Bus bus;
     TSC2046EventHandler *eventHandler;
     unsigned cs;
     unsigned threshold;
     boolean touched;
     unsigned posX;
     unsigned posY;
+    SPIQueue *queue;
+    volatile boolean pending;
+    u8 rxAsync[TSC2046_SAMPLE_SIZE];
+    SPIQueueCallback *updateCallback;
+    void *updateParam;
+};
+
+template <class Bus>
+const char TSC2046DeviceT<Bus>::FromTSC2046[] = "tsc2046";
+
+// three conversions each of Z1, Z2, X and Y, the last one powers down
+template <class Bus>
+const u8 TSC2046DeviceT<Bus>::TSC2046SampleCommands[TSC2046_SAMPLE_SIZE] = {
+    0xB1, 0, 0, 0xB1, 0, 0, 0xB1, 0, 0,
+    0xC1, 0, 0, 0xC1, 0, 0, 0xC1, 0, 0,
+    0x91, 0, 0, 0x91, 0, 0, 0x91, 0, 0,
+    0xD1, 0, 0, 0xD1, 0, 0, 0xD0, 0, 0
 };
 
+template <class Bus>
+TSC2046DeviceT<Bus>::TSC2046DeviceT(Bus _bus, unsigned _cs, unsigned _threshold)
+    : bus(_bus) ,
+      eventHandler(0),
+      cs(_cs),
+      threshold(_threshold),
+      touched(FALSE),
+      queue(0),
+      pending(FALSE),
+      updateCallback(0),
+      updateParam(0)
+{
+}
+
+template <class Bus>
+TSC2046DeviceT<Bus>::~TSC2046DeviceT(void)
+{
+}
+
+template <class Bus>
+boolean TSC2046DeviceT<Bus>::Initialize(void)
+{
+    // perform a dummy read to see if the device responds
+    u8 txBuffer[3] = {0};
+    u8 rxBuffer[3] = {0};
+    txBuffer[0] = 0xB0;
+    if (bus.WriteRead(cs, txBuffer, rxBuffer, sizeof(txBuffer)) != sizeof(txBuffer)) {
+        CLogger::Get()->Write(FromTSC2046, LogError, "SPI write/read error");
+        return FALSE;
+    }
+
+    CDeviceNameService::Get()->AddDevice("touch1", this, FALSE);
+
+    return TRUE;
+}
+
+template <class Bus>
+void TSC2046DeviceT<Bus>::Update(void)
+{
+    u8 rxBuffer[TSC2046_SAMPLE_SIZE] = {0};
+
+    if (bus.WriteRead(cs, TSC2046SampleCommands, rxBuffer, sizeof(rxBuffer)) != sizeof(rxBuffer)) {
+        CLogger::Get()->Write(FromTSC2046, LogError, "SPI write/read error");
+        return;
+    }
+
+    Process(rxBuffer);
+}
+
+template <class Bus>
+void TSC2046DeviceT<Bus>::SetQueue(SPIQueue *_queue)
+{
+    queue = _queue;
+}
+
+template <class Bus>
+boolean TSC2046DeviceT<Bus>::UpdateAsync(SPIQueueCallback *_callback, void *_param)
+{
+    assert(queue != 0);
+    if (pending) {
+        return FALSE;
+    }
+
+    updateCallback = _callback;
+    updateParam = _param;
+    pending = TRUE;
+    if (! queue->WriteInline(cs, 0, 0, TSC2046SampleCommands, sizeof(TSC2046SampleCommands),
+                             rxAsync, UpdateDone, this)) {
+        pending = FALSE;
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+template <class Bus>
+void TSC2046DeviceT<Bus>::UpdateDone(boolean _ok, void *_param)
+{
+    TSC2046DeviceT *pThis = (TSC2046DeviceT *)_param;
+    assert(pThis != 0);
+
+    if (_ok) {
+        pThis->Process(pThis->rxAsync);
+    } else {
+        CLogger::Get()->Write(FromTSC2046, LogError, "SPI write/read error");
+    }
+
+    SPIQueueCallback *callback = pThis->updateCallback;
+    void *param = pThis->updateParam;
+    pThis->pending = FALSE;
+    if (callback != 0) {
+        (*callback)(_ok, param);
+    }
+}
+
+template <class Bus>
+void TSC2046DeviceT<Bus>::Process(const u8 *_rxBuffer)
+{
+    unsigned z1 = (_rxBuffer[7] << 8 | _rxBuffer[8]) >> 3;
+    unsigned z2 = (_rxBuffer[16] << 8 | _rxBuffer[17]) >> 3;
+    unsigned x = (_rxBuffer[25] << 8 | _rxBuffer[26]) >> 3;
+    unsigned y = (_rxBuffer[34] << 8 | _rxBuffer[35]) >> 3;
+    unsigned z = z1 + 4095;
+    z -= z2;
+
+    // nothing to do if we no pressure detected or no release event to report
+    if ((z < threshold) && (! touched)) {
+        return;
+    }
+
+    if (z > threshold) {
+        if (! touched) {
+            posX = x;
+            posY = y;
+
+            if (eventHandler != 0) {
+                (*eventHandler)(TSC2046EventFingerDown, 0, x, y);
+            }
+        } else {
+            if (x != posX || y != posY) {
+                posX = x;
+                posY = y;
+
+                if (eventHandler != 0) {
+                    (*eventHandler)(TSC2046EventFingerMove, 0, x, y);
+                }
+            }
+        }
+        touched = TRUE;
+    } else {
+        if (eventHandler != 0) {
+            (*eventHandler)(TSC2046EventFingerUp, 0, 0, 0);
+        }
+        touched = FALSE;
+    }
+}
+
+template <class Bus>
+void TSC2046DeviceT<Bus>::RegisterEventHandler(TSC2046EventHandler *_eventHandler)
+{
+    assert(eventHandler == 0);
+    eventHandler = _eventHandler;
+    assert(eventHandler != 0);
+}
+
+typedef TSC2046DeviceT<SPIBus> TSC2046Device;
+
+// the library instantiates the drivers for its own bus types, other ones
+// like mock buses for host builds are instantiated where they are used
+extern template class TSC2046DeviceT<SPIBus>;
+extern template class TSC2046DeviceT<SPIMasterBus>;
+extern template class TSC2046DeviceT<SPIMasterAUXBus>;
+
 #endif // _tsc2046_h
@@ -0,0 +1,130 @@
+//
+// antialias.cpp
+//
+// Anti-aliased lines and 4 bit alpha bitmaps
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <excircles/antialias.h>
+#include <excircles/rgb565.h>
+#include <assert.h>
+
+AntiAlias::AntiAlias(DisplayDevice *_display)
+    : display(_display)
+{
+    assert(display != 0);
+    SetColor(0xFFFF, 0x0000);
+}
+
+AntiAlias::~AntiAlias(void)
+{
+    display = 0;
+}
+
+void AntiAlias::SetColor(u16 _fg, u16 _bg)
+{
+    // 4 bit alpha scaled to the 0..32 range of Blend565()
+    for (unsigned i = 0; i < AA_ALPHA_LEVELS; i++) {
+        blend[i] = Blend565(_fg, _bg, (i * 32 + 7) / 15);
+    }
+}
+
+void AntiAlias::DrawLine(int _x1, int _y1, int _x2, int _y2)
+{
+    int deltaX = _x2-_x1 >= 0 ? _x2-_x1 : _x1-_x2;
+    int deltaY = _y2-_y1 >= 0 ? _y2-_y1 : _y1-_y2;
+
+    // walk along the major axis
+    boolean steep = deltaY > deltaX;
+    if (steep) {
+        int t;
+        t = _x1; _x1 = _y1; _y1 = t;
+        t = _x2; _x2 = _y2; _y2 = t;
+        t = deltaX; deltaX = deltaY; deltaY = t;
+    }
+    if (_x1 > _x2) {
+        int t;
+        t = _x1; _x1 = _x2; _x2 = t;
+        t = _y1; _y1 = _y2; _y2 = t;
+    }
+
+    // minor axis position and slope in 16.16 fixed point; multiplied, as
+    // shifting a negative value left is undefined
+    int gradient = deltaX == 0 ? 0 : (_y2 - _y1) * 65536 / deltaX;
+    int y = _y1 * 65536;
+    for (int x = _x1; x <= _x2; x++) {
+        // coverage of the second pixel of the pair
+        PlotPair(x, y >> 16, steep, (y >> 12) & 0x0F);
+        y += gradient;
+    }
+}
+
+void AntiAlias::PlotPair(int _x, int _y, boolean _steep, unsigned _alpha)
+{
+    int w = display->GetWidth();
+    int h = display->GetHeight();
+    int x = _steep ? _y : _x;
+    int y = _steep ? _x : _y;
+    // position of the second pixel relative to the first one
+    int nextX = _steep ? x + 1 : x;
+    int nextY = _steep ? y : y + 1;
+
+    boolean first = x >= 0 && x < w && y >= 0 && y < h;
+    boolean second = _alpha > 0 && nextX >= 0 && nextX < w && nextY >= 0 && nextY < h;
+
+    u16 pixels[2];
+    pixels[0] = blend[AA_ALPHA_LEVELS-1 - _alpha];
+    pixels[1] = blend[_alpha];
+
+    if (first && second) {
+        display->SetXY(x, nextX, y, nextY);
+        display->WritePixels(pixels, 2);
+    } else if (first) {
+        display->SetXY(x, x, y, y);
+        display->WritePixels(&pixels[0], 1);
+    } else if (second) {
+        display->SetXY(nextX, nextX, nextY, nextY);
+        display->WritePixels(&pixels[1], 1);
+    }
+}
+
+void AntiAlias::DrawAlphaBitmap(unsigned _x, unsigned _y, unsigned _width, unsigned _height,
+                                const u8 *_alpha)
+{
+    assert(_alpha != 0);
+    assert(_x + _width <= display->GetWidth());
+    assert(_y + _height <= display->GetHeight());
+    if (_width == 0 || _height == 0) {
+        return;
+    }
+
+    display->SetXY(_x, _x + _width-1, _y, _y + _height-1);
+    unsigned pitch = (_width + 1) / 2;
+    for (unsigned j = 0; j < _height; j++) {
+        const u8 *row = _alpha + j * pitch;
+        unsigned i = 0;
+        while (i < _width) {
+            unsigned n = _width - i;
+            if (n > AA_LINE_BUFFER_SIZE) {
+                n = AA_LINE_BUFFER_SIZE;
+            }
+            for (unsigned k = 0; k < n; k++, i++) {
+                unsigned alpha = (i & 1) ? row[i / 2] & 0x0F : row[i / 2] >> 4;
+                lineBuffer[k] = blend[alpha];
+            }
+            display->WritePixels(lineBuffer, n);
+        }
+    }
+}
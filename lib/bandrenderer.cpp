@@ -0,0 +1,161 @@
+//
+// bandrenderer.cpp
+//
+// Full frame rendering in horizontal bands spread over all cores
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <excircles/bandrenderer.h>
+
+#ifdef ARM_ALLOW_MULTI_CORE
+
+#include <circle/logger.h>
+#include <circle/synchronize.h>
+#include <assert.h>
+
+static const char FromBandRenderer[] = "bandrenderer";
+
+BandRenderer::BandRenderer(CMemorySystem *_memory, DisplayDevice *_display)
+    : CMultiCoreSupport(_memory),
+      display(_display),
+      bands(0),
+      callback(0),
+      callbackParam(0),
+      frame(0)
+{
+    assert(display != 0);
+
+    for (unsigned core = 0; core < CORES; core++) {
+        for (unsigned i = 0; i < BAND_RENDERER_BUFFERS; i++) {
+            buffers[core][i] = 0;
+        }
+        scratch[core] = 0;
+    }
+}
+
+BandRenderer::~BandRenderer(void)
+{
+    for (unsigned core = 0; core < CORES; core++) {
+        for (unsigned i = 0; i < BAND_RENDERER_BUFFERS; i++) {
+            delete [] buffers[core][i];
+        }
+        delete [] scratch[core];
+    }
+    display = 0;
+}
+
+boolean BandRenderer::Initialize(void)
+{
+    bands = (display->GetHeight() + BAND_RENDERER_LINES-1) / BAND_RENDERER_LINES;
+
+    for (unsigned core = 0; core < CORES; core++) {
+        for (unsigned i = 0; i < BAND_RENDERER_BUFFERS; i++) {
+            buffers[core][i] = new u16[display->GetWidth() * BAND_RENDERER_LINES];
+            if (buffers[core][i] == 0) {
+                CLogger::Get()->Write(FromBandRenderer, LogError, "Cannot allocate the band buffers");
+                return FALSE;
+            }
+            freeBuffers[core].Push(buffers[core][i]);
+        }
+        scratch[core] = new u8[BAND_RENDERER_SCRATCH_SIZE];
+        if (scratch[core] == 0) {
+            CLogger::Get()->Write(FromBandRenderer, LogError, "Cannot allocate the scratch memory");
+            return FALSE;
+        }
+    }
+
+    if (! CMultiCoreSupport::Initialize()) {
+        CLogger::Get()->Write(FromBandRenderer, LogError, "Cannot start the secondary cores");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+void BandRenderer::RenderBand(unsigned _core, unsigned _band, u16 *_pixels)
+{
+    unsigned y = _band * BAND_RENDERER_LINES;
+    unsigned lines = display->GetHeight() - y;
+    if (lines > BAND_RENDERER_LINES) {
+        lines = BAND_RENDERER_LINES;
+    }
+
+    (*callback)(y, lines, _pixels, display->GetWidth(), scratch[_core], callbackParam);
+}
+
+void BandRenderer::Render(BandRenderCallback *_callback, void *_param)
+{
+    assert(ThisCore() == 0);
+    assert(_callback != 0);
+
+    callback = _callback;
+    callbackParam = _param;
+    // the callback is in place before the other cores see the new frame
+    DataMemBarrier();
+    frame = frame + 1;
+
+    unsigned width = display->GetWidth();
+    unsigned height = display->GetHeight();
+    display->SetXY(0, width-1, 0, height-1);
+
+    for (unsigned band = 0; band < bands; band++) {
+        unsigned core = band % CORES;
+        unsigned lines = height - band * BAND_RENDERER_LINES;
+        if (lines > BAND_RENDERER_LINES) {
+            lines = BAND_RENDERER_LINES;
+        }
+
+        if (core == 0) {
+            // our own bands, rendered in between sending the others
+            RenderBand(0, band, buffers[0][0]);
+            display->WritePixels(buffers[0][0], lines * width);
+            continue;
+        }
+
+        u16 *pixels;
+        while (! readyBands[core].Pop(&pixels)) {
+            // the band is still being rendered
+        }
+        display->WritePixels(pixels, lines * width);
+        freeBuffers[core].Push(pixels);
+    }
+}
+
+void BandRenderer::Run(unsigned _core)
+{
+    if (_core == 0) {
+        return;
+    }
+
+    unsigned seen = 0;
+    for (;;) {
+        while (frame == seen) {
+            // wait for the next frame
+        }
+        seen = frame;
+        DataMemBarrier();
+
+        for (unsigned band = _core; band < bands; band += CORES) {
+            u16 *pixels;
+            while (! freeBuffers[_core].Pop(&pixels)) {
+                // core 0 has not sent our previous band yet
+            }
+            RenderBand(_core, band, pixels);
+            readyBands[_core].Push(pixels);
+        }
+    }
+}
+
+#endif // ARM_ALLOW_MULTI_CORE
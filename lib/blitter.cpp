@@ -0,0 +1,308 @@
+//
+// blitter.cpp
+//
+// Scaling and rotating blitter with a viewport over a large canvas
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <circle/logger.h>
+#include <circle/util.h>
+#include <excircles/blitter.h>
+#include <excircles/rgb565.h>
+#include <assert.h>
+
+static const char FromBlitter[] = "blitter";
+
+// sin() of 0..90 degrees in 16.16 fixed point
+static const s32 SineTable[91] = {
+    0, 1144, 2287, 3430, 4572, 5712, 6850, 7987,
+    9121, 10252, 11380, 12505, 13626, 14742, 15855, 16962,
+    18064, 19161, 20252, 21336, 22415, 23486, 24550, 25607,
+    26656, 27697, 28729, 29753, 30767, 31772, 32768, 33754,
+    34729, 35693, 36647, 37590, 38521, 39441, 40348, 41243,
+    42126, 42995, 43852, 44695, 45525, 46341, 47143, 47930,
+    48703, 49461, 50203, 50931, 51643, 52339, 53020, 53684,
+    54332, 54963, 55578, 56175, 56756, 57319, 57865, 58393,
+    58903, 59396, 59870, 60326, 60764, 61183, 61584, 61966,
+    62328, 62672, 62997, 63303, 63589, 63856, 64104, 64332,
+    64540, 64729, 64898, 65048, 65177, 65287, 65376, 65446,
+    65496, 65526, 65536,
+};
+
+static s32 Sine(unsigned _angle)
+{
+    _angle %= 360;
+    if (_angle <= 90) {
+        return SineTable[_angle];
+    } else if (_angle <= 180) {
+        return SineTable[180 - _angle];
+    } else if (_angle <= 270) {
+        return -SineTable[_angle - 180];
+    }
+    return -SineTable[360 - _angle];
+}
+
+static inline int FloorDiv(int _value, int _divisor)
+{
+    return _value >= 0 ? _value / _divisor : -((-_value + _divisor-1) / _divisor);
+}
+
+Blitter::Blitter(DisplayDevice *_display)
+    : display(_display),
+      filter(BlitFilterNearest),
+      background(0x0000),
+      scale(BLIT_SCALE_ONE),
+      angle(0),
+      canvasWidth(0),
+      canvasHeight(0),
+      viewX(0),
+      viewY(0),
+      viewWidth(0),
+      viewHeight(0),
+      lineBuffer(0),
+      tileColumns(0),
+      tileRows(0),
+      tiles(0),
+      tileTagX(0),
+      tileTagY(0),
+      tileValid(0),
+      tilesResampled(0),
+      tilesCached(0)
+{
+    assert(display != 0);
+
+    source.pixels = 0;
+    source.width = 0;
+    source.height = 0;
+    source.pitch = 0;
+    SetTransform(scale, angle);
+}
+
+Blitter::~Blitter(void)
+{
+    delete [] lineBuffer;
+    delete [] tiles;
+    delete [] tileTagX;
+    delete [] tileTagY;
+    delete [] tileValid;
+    display = 0;
+}
+
+void Blitter::SetSource(const Image565 *_source)
+{
+    assert(_source != 0);
+    assert(_source->pixels != 0);
+    assert(_source->pitch >= _source->width);
+
+    source = *_source;
+    // same transform, but the canvas size and the origin depend on the source
+    SetTransform(scale, angle);
+}
+
+void Blitter::SetFilter(BlitFilter _filter)
+{
+    filter = _filter;
+    Invalidate();
+}
+
+void Blitter::SetTransform(unsigned _scale, unsigned _angle)
+{
+    assert(_scale > 0);
+
+    scale = _scale;
+    angle = _angle;
+
+    s32 sine = Sine(_angle);
+    s32 cosine = Sine(_angle + 90);
+    u64 absSine = sine < 0 ? -sine : sine;
+    u64 absCosine = cosine < 0 ? -cosine : cosine;
+
+    // bounding box of the scaled and rotated source
+    u64 w = (source.width * absCosine + source.height * absSine) * _scale;
+    u64 h = (source.width * absSine + source.height * absCosine) * _scale;
+    canvasWidth = (unsigned)((w + 0xFFFFFFFFULL) >> 32);
+    canvasHeight = (unsigned)((h + 0xFFFFFFFFULL) >> 32);
+
+    // inverse mapping, canvas pixel to source position
+    mapXX = (s32)((s64)cosine * 0x10000 / _scale);
+    mapXY = (s32)((s64)-sine * 0x10000 / _scale);
+    mapYX = (s32)((s64)sine * 0x10000 / _scale);
+    mapYY = (s32)((s64)cosine * 0x10000 / _scale);
+
+    // canvas pixel centers relative to the canvas center
+    s64 dx = 0x8000 - ((s64)canvasWidth << 15);
+    s64 dy = 0x8000 - ((s64)canvasHeight << 15);
+    originX = ((s64)source.width << 15) + ((mapXX * dx + mapXY * dy) >> 16);
+    originY = ((s64)source.height << 15) + ((mapYX * dx + mapYY * dy) >> 16);
+
+    Invalidate();
+}
+
+void Blitter::SetBackground(u16 _color)
+{
+    background = _color;
+    Invalidate();
+}
+
+boolean Blitter::SetViewport(unsigned _x, unsigned _y, unsigned _width, unsigned _height)
+{
+    assert(_width > 0 && _height > 0);
+    assert(_x + _width <= display->GetWidth());
+    assert(_y + _height <= display->GetHeight());
+
+    delete [] lineBuffer;
+    delete [] tiles;
+    delete [] tileTagX;
+    delete [] tileTagY;
+    delete [] tileValid;
+
+    viewX = _x;
+    viewY = _y;
+    viewWidth = _width;
+    viewHeight = _height;
+
+    // enough slots that no two tiles of one view share a slot
+    tileColumns = (_width + BLIT_TILE_SIZE-1) / BLIT_TILE_SIZE + 1;
+    tileRows = (_height + BLIT_TILE_SIZE-1) / BLIT_TILE_SIZE + 1;
+    unsigned slots = tileColumns * tileRows;
+
+    lineBuffer = new u16[_width];
+    tiles = new u16[slots * BLIT_TILE_SIZE * BLIT_TILE_SIZE];
+    tileTagX = new int[slots];
+    tileTagY = new int[slots];
+    tileValid = new boolean[slots];
+    if (lineBuffer == 0 || tiles == 0 || tileTagX == 0 || tileTagY == 0 || tileValid == 0) {
+        CLogger::Get()->Write(FromBlitter, LogError, "Cannot allocate the tile cache");
+        viewWidth = 0;
+        return FALSE;
+    }
+
+    Invalidate();
+    return TRUE;
+}
+
+void Blitter::Invalidate(void)
+{
+    for (unsigned i = 0; tileValid != 0 && i < tileColumns * tileRows; i++) {
+        tileValid[i] = FALSE;
+    }
+}
+
+void Blitter::Draw(int _panX, int _panY)
+{
+    if (viewWidth == 0 || source.pixels == 0) {
+        return;
+    }
+
+    tilesResampled = 0;
+    tilesCached = 0;
+
+    display->SetXY(viewX, viewX + viewWidth-1, viewY, viewY + viewHeight-1);
+    for (unsigned j = 0; j < viewHeight; j++) {
+        int canvasY = _panY + (int)j;
+        int tileY = FloorDiv(canvasY, BLIT_TILE_SIZE);
+        unsigned offsetY = canvasY - tileY * BLIT_TILE_SIZE;
+
+        unsigned i = 0;
+        while (i < viewWidth) {
+            int canvasX = _panX + (int)i;
+            int tileX = FloorDiv(canvasX, BLIT_TILE_SIZE);
+            unsigned offsetX = canvasX - tileX * BLIT_TILE_SIZE;
+            unsigned count = BLIT_TILE_SIZE - offsetX;
+            if (count > viewWidth - i) {
+                count = viewWidth - i;
+            }
+
+            // count each tile once, when its first row is shown
+            unsigned resampled = tilesResampled;
+            const u16 *tile = GetTile(tileX, tileY);
+            if ((j == 0 || offsetY == 0) && tilesResampled == resampled) {
+                tilesCached++;
+            }
+            memcpy(&lineBuffer[i], &tile[offsetY * BLIT_TILE_SIZE + offsetX], count * sizeof(u16));
+            i += count;
+        }
+
+        display->WritePixels(lineBuffer, viewWidth);
+    }
+}
+
+const u16 *Blitter::GetTile(int _tileX, int _tileY)
+{
+    unsigned column = (unsigned)(_tileX - FloorDiv(_tileX, tileColumns) * (int)tileColumns);
+    unsigned row = (unsigned)(_tileY - FloorDiv(_tileY, tileRows) * (int)tileRows);
+    unsigned slot = row * tileColumns + column;
+    u16 *tile = &tiles[slot * BLIT_TILE_SIZE * BLIT_TILE_SIZE];
+
+    if (! tileValid[slot] || tileTagX[slot] != _tileX || tileTagY[slot] != _tileY) {
+        Resample(tile, _tileX * BLIT_TILE_SIZE, _tileY * BLIT_TILE_SIZE);
+        tileTagX[slot] = _tileX;
+        tileTagY[slot] = _tileY;
+        tileValid[slot] = TRUE;
+        tilesResampled++;
+    }
+
+    return tile;
+}
+
+inline u16 Blitter::Fetch(int _x, int _y) const
+{
+    if ((unsigned)_x < source.width && (unsigned)_y < source.height) {
+        return source.pixels[_y * source.pitch + _x];
+    }
+    return background;
+}
+
+void Blitter::Resample(u16 *_tile, int _canvasX, int _canvasY)
+{
+    // nothing to sample outside of the canvas
+    if (_canvasX >= (int)canvasWidth || _canvasY >= (int)canvasHeight
+        || _canvasX + BLIT_TILE_SIZE <= 0 || _canvasY + BLIT_TILE_SIZE <= 0) {
+        for (unsigned i = 0; i < BLIT_TILE_SIZE * BLIT_TILE_SIZE; i++) {
+            _tile[i] = background;
+        }
+        return;
+    }
+
+    for (int j = 0; j < BLIT_TILE_SIZE; j++) {
+        // source position of the first pixel of the row, the rest follows
+        // by adding the first column of the mapping
+        s32 sx = (s32)(originX + (s64)mapXX * _canvasX + (s64)mapXY * (_canvasY + j));
+        s32 sy = (s32)(originY + (s64)mapYX * _canvasX + (s64)mapYY * (_canvasY + j));
+
+        if (filter == BlitFilterNearest) {
+            for (int i = 0; i < BLIT_TILE_SIZE; i++) {
+                *_tile++ = Fetch(sx >> 16, sy >> 16);
+                sx += mapXX;
+                sy += mapYX;
+            }
+        } else {
+            // sample between the four closest source pixel centers
+            sx -= 0x8000;
+            sy -= 0x8000;
+            for (int i = 0; i < BLIT_TILE_SIZE; i++) {
+                int x = sx >> 16;
+                int y = sy >> 16;
+                unsigned wx = (sx >> 11) & 0x1F;
+                unsigned wy = (sy >> 11) & 0x1F;
+                u16 top = Blend565(Fetch(x + 1, y), Fetch(x, y), wx);
+                u16 bottom = Blend565(Fetch(x + 1, y + 1), Fetch(x, y + 1), wx);
+                *_tile++ = Blend565(bottom, top, wy);
+                sx += mapXX;
+                sy += mapYX;
+            }
+        }
+    }
+}
@@ -0,0 +1,288 @@
+//
+// compositor.cpp
+//
+// Tile based compositor for sprite and overlay layers over a background
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <circle/logger.h>
+#include <circle/util.h>
+#include <excircles/compositor.h>
+#include <assert.h>
+
+static const char FromCompositor[] = "compositor";
+
+Compositor::Compositor(DisplayDevice *_display)
+    : display(_display),
+      backgroundColor(0x0000),
+      tileColumns(0),
+      tileRows(0),
+      dirtyTiles(0),
+      spanBuffer(0),
+      tilesSent(0),
+      windowsSent(0)
+{
+    assert(display != 0);
+
+    background.pixels = 0;
+    background.width = 0;
+    background.height = 0;
+    background.pitch = 0;
+    for (unsigned i = 0; i < COMPOSITOR_MAX_LAYERS; i++) {
+        layers[i].image = background;
+        layers[i].x = 0;
+        layers[i].y = 0;
+        layers[i].visible = FALSE;
+        layers[i].transparent = FALSE;
+        layers[i].key = 0x0000;
+    }
+}
+
+Compositor::~Compositor(void)
+{
+    delete [] dirtyTiles;
+    delete [] spanBuffer;
+    display = 0;
+}
+
+boolean Compositor::Initialize(void)
+{
+    tileColumns = (display->GetWidth() + COMPOSITOR_TILE_SIZE-1) / COMPOSITOR_TILE_SIZE;
+    tileRows = (display->GetHeight() + COMPOSITOR_TILE_SIZE-1) / COMPOSITOR_TILE_SIZE;
+
+    dirtyTiles = new u8[tileColumns * tileRows];
+    spanBuffer = new u16[display->GetWidth() * COMPOSITOR_TILE_SIZE];
+    if (dirtyTiles == 0 || spanBuffer == 0) {
+        CLogger::Get()->Write(FromCompositor, LogError, "Cannot allocate the tile buffers");
+        return FALSE;
+    }
+
+    // the first update draws the whole screen
+    memset(dirtyTiles, 1, tileColumns * tileRows);
+    return TRUE;
+}
+
+void Compositor::SetBackground(const Image565 *_image)
+{
+    assert(_image != 0);
+    assert(_image->pixels != 0);
+    assert(_image->width >= display->GetWidth());
+    assert(_image->height >= display->GetHeight());
+    assert(_image->pitch >= _image->width);
+
+    background = *_image;
+    Invalidate(0, 0, display->GetWidth(), display->GetHeight());
+}
+
+void Compositor::SetBackgroundColor(u16 _color)
+{
+    backgroundColor = _color;
+    if (background.pixels == 0) {
+        Invalidate(0, 0, display->GetWidth(), display->GetHeight());
+    }
+}
+
+void Compositor::SetLayer(unsigned _layer, const Image565 *_image)
+{
+    assert(_layer < COMPOSITOR_MAX_LAYERS);
+    assert(_image != 0);
+    assert(_image->pixels != 0);
+    assert(_image->pitch >= _image->width);
+
+    MarkLayer(_layer);
+    layers[_layer].image = *_image;
+    MarkLayer(_layer);
+}
+
+void Compositor::SetLayerKey(unsigned _layer, u16 _key)
+{
+    assert(_layer < COMPOSITOR_MAX_LAYERS);
+
+    layers[_layer].transparent = TRUE;
+    layers[_layer].key = _key;
+    MarkLayer(_layer);
+}
+
+void Compositor::MoveLayer(unsigned _layer, int _x, int _y)
+{
+    assert(_layer < COMPOSITOR_MAX_LAYERS);
+
+    if (layers[_layer].x == _x && layers[_layer].y == _y) {
+        return;
+    }
+
+    MarkLayer(_layer);
+    layers[_layer].x = _x;
+    layers[_layer].y = _y;
+    MarkLayer(_layer);
+}
+
+void Compositor::ShowLayer(unsigned _layer, boolean _visible)
+{
+    assert(_layer < COMPOSITOR_MAX_LAYERS);
+
+    if (layers[_layer].visible == _visible) {
+        return;
+    }
+
+    // mark while visible, covers both showing and hiding
+    layers[_layer].visible = TRUE;
+    MarkLayer(_layer);
+    layers[_layer].visible = _visible;
+}
+
+void Compositor::InvalidateLayer(unsigned _layer)
+{
+    assert(_layer < COMPOSITOR_MAX_LAYERS);
+
+    MarkLayer(_layer);
+}
+
+void Compositor::Invalidate(unsigned _x, unsigned _y, unsigned _width, unsigned _height)
+{
+    MarkArea((int)_x, (int)_y, (int)_width, (int)_height);
+}
+
+void Compositor::MarkLayer(unsigned _layer)
+{
+    const CompositorLayer &layer = layers[_layer];
+    if (layer.visible && layer.image.pixels != 0) {
+        MarkArea(layer.x, layer.y, (int)layer.image.width, (int)layer.image.height);
+    }
+}
+
+void Compositor::MarkArea(int _x, int _y, int _width, int _height)
+{
+    if (dirtyTiles == 0) {
+        return;
+    }
+
+    int x0 = _x < 0 ? 0 : _x;
+    int y0 = _y < 0 ? 0 : _y;
+    int x1 = _x + _width;
+    int y1 = _y + _height;
+    if (x1 > (int)display->GetWidth()) {
+        x1 = display->GetWidth();
+    }
+    if (y1 > (int)display->GetHeight()) {
+        y1 = display->GetHeight();
+    }
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+
+    for (int ty = y0 / COMPOSITOR_TILE_SIZE; ty <= (y1-1) / COMPOSITOR_TILE_SIZE; ty++) {
+        for (int tx = x0 / COMPOSITOR_TILE_SIZE; tx <= (x1-1) / COMPOSITOR_TILE_SIZE; tx++) {
+            dirtyTiles[ty * tileColumns + tx] = 1;
+        }
+    }
+}
+
+void Compositor::Update(void)
+{
+    tilesSent = 0;
+    windowsSent = 0;
+    if (dirtyTiles == 0) {
+        return;
+    }
+
+    for (unsigned ty = 0; ty < tileRows; ty++) {
+        u8 *row = &dirtyTiles[ty * tileColumns];
+        unsigned tx = 0;
+        while (tx < tileColumns) {
+            if (! row[tx]) {
+                tx++;
+                continue;
+            }
+
+            // neighbouring dirty tiles go out in one window
+            unsigned first = tx;
+            while (tx < tileColumns && row[tx]) {
+                row[tx++] = 0;
+            }
+
+            unsigned x0 = first * COMPOSITOR_TILE_SIZE;
+            unsigned x1 = tx * COMPOSITOR_TILE_SIZE - 1;
+            unsigned y0 = ty * COMPOSITOR_TILE_SIZE;
+            unsigned y1 = y0 + COMPOSITOR_TILE_SIZE - 1;
+            if (x1 >= display->GetWidth()) {
+                x1 = display->GetWidth() - 1;
+            }
+            if (y1 >= display->GetHeight()) {
+                y1 = display->GetHeight() - 1;
+            }
+
+            Compose(x0, x1, y0, y1);
+            display->SetXY(x0, x1, y0, y1);
+            display->WritePixels(spanBuffer, (x1 - x0 + 1) * (y1 - y0 + 1));
+            tilesSent += tx - first;
+            windowsSent++;
+        }
+    }
+}
+
+void Compositor::Compose(unsigned _x0, unsigned _x1, unsigned _y0, unsigned _y1)
+{
+    unsigned w = _x1 - _x0 + 1;
+    unsigned h = _y1 - _y0 + 1;
+
+    if (background.pixels != 0) {
+        for (unsigned j = 0; j < h; j++) {
+            memcpy(&spanBuffer[j * w], &background.pixels[(_y0 + j) * background.pitch + _x0],
+                w * sizeof(u16));
+        }
+    } else {
+        for (unsigned i = 0; i < w * h; i++) {
+            spanBuffer[i] = backgroundColor;
+        }
+    }
+
+    for (unsigned l = 0; l < COMPOSITOR_MAX_LAYERS; l++) {
+        const CompositorLayer &layer = layers[l];
+        if (! layer.visible || layer.image.pixels == 0) {
+            continue;
+        }
+
+        // intersection of the layer with the span, in screen coordinates
+        int x0 = layer.x > (int)_x0 ? layer.x : (int)_x0;
+        int y0 = layer.y > (int)_y0 ? layer.y : (int)_y0;
+        int x1 = layer.x + (int)layer.image.width - 1;
+        int y1 = layer.y + (int)layer.image.height - 1;
+        if (x1 > (int)_x1) {
+            x1 = _x1;
+        }
+        if (y1 > (int)_y1) {
+            y1 = _y1;
+        }
+        if (x0 > x1 || y0 > y1) {
+            continue;
+        }
+
+        unsigned count = x1 - x0 + 1;
+        for (int y = y0; y <= y1; y++) {
+            const u16 *src = &layer.image.pixels[(y - layer.y) * layer.image.pitch + (x0 - layer.x)];
+            u16 *dst = &spanBuffer[(y - _y0) * w + (x0 - _x0)];
+            if (! layer.transparent) {
+                memcpy(dst, src, count * sizeof(u16));
+                continue;
+            }
+            for (unsigned i = 0; i < count; i++) {
+                if (src[i] != layer.key) {
+                    dst[i] = src[i];
+                }
+            }
+        }
+    }
+}
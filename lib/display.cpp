@@ -0,0 +1,88 @@
+//
+// display.cpp
+//
+// Common interface of the graphical LCD device drivers
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <excircles/display.h>
+#include <excircles/pixelformat.h>
+#include <assert.h>
+
+DisplayDevice::DisplayDevice(unsigned _width, unsigned _height)
+    : width(_width),
+      height(_height)
+{
+    assert(width > 0);
+    assert(height > 0);
+}
+
+DisplayDevice::~DisplayDevice(void)
+{
+}
+
+void DisplayDevice::FillRect(unsigned _x, unsigned _y, unsigned _width, unsigned _height, u16 _color)
+{
+    if (_x >= width || _y >= height || _width == 0 || _height == 0) {
+        return;
+    }
+    // clip to the panel
+    if (_x + _width > width) {
+        _width = width - _x;
+    }
+    if (_y + _height > height) {
+        _height = height - _y;
+    }
+
+    SetXY(_x, _x + _width-1, _y, _y + _height-1);
+    FillPixels(_color, _width * _height);
+}
+
+unsigned DisplayDevice::GetBytesPerPixel(void) const
+{
+    return GetPixelFormat() == DisplayPixelFormatRGB565 ? 2 : 3;
+}
+
+template <class Format>
+static void UnpackRaw(DisplayDevice *_display, const u8 *_data, unsigned _length)
+{
+    u16 pixels[64];
+
+    assert(_length % Format::BytesPerPixel == 0);
+    unsigned count = _length / Format::BytesPerPixel;
+    while (count > 0) {
+        unsigned n = count < 64 ? count : 64;
+        UnpackPixels<Format>(pixels, _data, n);
+        _display->WritePixels(pixels, n);
+        _data += n * Format::BytesPerPixel;
+        count -= n;
+    }
+}
+
+void DisplayDevice::WriteRaw(const u8 *_data, unsigned _length)
+{
+    // devices without a wire format of their own get the pixels unpacked
+    switch (GetPixelFormat()) {
+    case DisplayPixelFormatRGB565:
+        UnpackRaw<PixelFormatRGB565>(this, _data, _length);
+        break;
+    case DisplayPixelFormatRGB666:
+        UnpackRaw<PixelFormatRGB666>(this, _data, _length);
+        break;
+    case DisplayPixelFormatRGB888:
+        UnpackRaw<PixelFormatRGB888>(this, _data, _length);
+        break;
+    }
+}
@@ -0,0 +1,472 @@
+//
+// displaylist.cpp
+//
+// Recorded draw commands, optimized and executed later
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <circle/logger.h>
+#include <circle/util.h>
+#include <excircles/displaylist.h>
+#include <assert.h>
+
+static const char FromDisplayList[] = "displaylist";
+
+static inline boolean Overlaps(const DisplayListEntry &_a, const DisplayListEntry &_b)
+{
+    return _a.x0 <= _b.x1 && _b.x0 <= _a.x1 && _a.y0 <= _b.y1 && _b.y0 <= _a.y1;
+}
+
+static inline boolean Contains(const DisplayListEntry &_outer, const DisplayListEntry &_inner)
+{
+    return _outer.x0 <= _inner.x0 && _outer.y0 <= _inner.y0
+        && _outer.x1 >= _inner.x1 && _outer.y1 >= _inner.y1;
+}
+
+// the union of two rectangles is a rectangle, no pixel outside of them
+static inline boolean FormRect(const DisplayListEntry &_a, const DisplayListEntry &_b)
+{
+    if (_a.x0 == _b.x0 && _a.x1 == _b.x1) {
+        return _a.y0 <= _b.y1 + 1 && _b.y0 <= _a.y1 + 1;
+    }
+    if (_a.y0 == _b.y0 && _a.y1 == _b.y1) {
+        return _a.x0 <= _b.x1 + 1 && _b.x0 <= _a.x1 + 1;
+    }
+    return FALSE;
+}
+
+static inline s16 Clamp16(int _value)
+{
+    return (s16)(_value < -32768 ? -32768 : _value > 32767 ? 32767 : _value);
+}
+
+DisplayList::DisplayList(DisplayDevice *_display, unsigned _arenaSize)
+    : display(_display),
+      arenaSize(_arenaSize),
+      memory(0),
+      arena(0),
+      arenaUsed(0),
+      entries(0),
+      order(0),
+      commandCount(0),
+      lineBuffer(0),
+      culled(0),
+      merged(0)
+{
+    assert(display != 0);
+}
+
+DisplayList::~DisplayList(void)
+{
+    delete [] memory;
+    memory = 0;
+    arena = 0;
+    delete [] entries;
+    delete [] order;
+    delete [] lineBuffer;
+    display = 0;
+}
+
+boolean DisplayList::Initialize(void)
+{
+    // command records keep the alignment of the first one
+    memory = new u8[arenaSize + alignof(DisplayListCommand)-1];
+    if (memory != 0) {
+        arena = (u8 *)(((uintptr)memory + alignof(DisplayListCommand)-1)
+                       & ~(uintptr)(alignof(DisplayListCommand)-1));
+    }
+    entries = new DisplayListEntry[DISPLAYLIST_MAX_COMMANDS];
+    order = new unsigned[DISPLAYLIST_MAX_COMMANDS];
+    lineBuffer = new u16[display->GetWidth()];
+    if (arena == 0 || entries == 0 || order == 0 || lineBuffer == 0) {
+        CLogger::Get()->Write(FromDisplayList, LogError, "Cannot allocate the display list");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+void DisplayList::Clear(void)
+{
+    arenaUsed = 0;
+    commandCount = 0;
+}
+
+DisplayListCommand *DisplayList::Allocate(DisplayListCommandType _type, unsigned _extra)
+{
+    unsigned size = sizeof(DisplayListCommand) + _extra;
+    size = (size + alignof(DisplayListCommand)-1) & ~(alignof(DisplayListCommand)-1);
+
+    if (arena == 0 || arenaUsed + size > arenaSize || commandCount == DISPLAYLIST_MAX_COMMANDS) {
+        CLogger::Get()->Write(FromDisplayList, LogError, "Display list is full");
+        return 0;
+    }
+
+    DisplayListCommand *command = (DisplayListCommand *)&arena[arenaUsed];
+    command->type = _type;
+    command->length = 0;
+    command->size = size;
+    arenaUsed += size;
+    commandCount++;
+
+    return command;
+}
+
+boolean DisplayList::Fill(int _x, int _y, unsigned _width, unsigned _height, u16 _color)
+{
+    if (_width == 0 || _height == 0) {
+        return TRUE;
+    }
+
+    DisplayListCommand *command = Allocate(DisplayListFill, 0);
+    if (command == 0) {
+        return FALSE;
+    }
+    command->x0 = Clamp16(_x);
+    command->y0 = Clamp16(_y);
+    command->x1 = Clamp16(_x + (int)_width - 1);
+    command->y1 = Clamp16(_y + (int)_height - 1);
+    command->fg = _color;
+    command->bg = _color;
+
+    return TRUE;
+}
+
+boolean DisplayList::Line(int _x0, int _y0, int _x1, int _y1, u16 _color)
+{
+    DisplayListCommand *command = Allocate(DisplayListLine, 0);
+    if (command == 0) {
+        return FALSE;
+    }
+    command->points[0] = Clamp16(_x0);
+    command->points[1] = Clamp16(_y0);
+    command->points[2] = Clamp16(_x1);
+    command->points[3] = Clamp16(_y1);
+    command->x0 = _x0 < _x1 ? command->points[0] : command->points[2];
+    command->y0 = _y0 < _y1 ? command->points[1] : command->points[3];
+    command->x1 = _x0 < _x1 ? command->points[2] : command->points[0];
+    command->y1 = _y0 < _y1 ? command->points[3] : command->points[1];
+    command->fg = _color;
+    command->bg = _color;
+
+    return TRUE;
+}
+
+boolean DisplayList::Text(int _x, int _y, const char *_text, u16 _fg, u16 _bg)
+{
+    assert(_text != 0);
+
+    unsigned length = strlen(_text);
+    if (length == 0) {
+        return TRUE;
+    }
+    if (length > 255) {
+        length = 255;
+    }
+
+    DisplayListCommand *command = Allocate(DisplayListText, length);
+    if (command == 0) {
+        return FALSE;
+    }
+    command->length = length;
+    memcpy(command + 1, _text, length);
+    command->x0 = Clamp16(_x);
+    command->y0 = Clamp16(_y);
+    command->x1 = Clamp16(_x + (int)(length * font.GetCharWidth()) - 1);
+    command->y1 = Clamp16(_y + (int)font.GetCharHeight() - 1);
+    command->fg = _fg;
+    command->bg = _bg;
+
+    return TRUE;
+}
+
+boolean DisplayList::Blit(int _x, int _y, const Image565 *_image)
+{
+    assert(_image != 0);
+    assert(_image->pixels != 0);
+
+    if (_image->width == 0 || _image->height == 0) {
+        return TRUE;
+    }
+
+    DisplayListCommand *command = Allocate(DisplayListBlit, 0);
+    if (command == 0) {
+        return FALSE;
+    }
+    command->image = _image;
+    command->x0 = Clamp16(_x);
+    command->y0 = Clamp16(_y);
+    command->x1 = Clamp16(_x + (int)_image->width - 1);
+    command->y1 = Clamp16(_y + (int)_image->height - 1);
+    command->fg = 0;
+    command->bg = 0;
+
+    return TRUE;
+}
+
+void DisplayList::Execute(void)
+{
+    culled = 0;
+    merged = 0;
+    if (arena == 0) {
+        return;
+    }
+
+    unsigned count = 0;
+    for (unsigned offset = 0; offset < arenaUsed; count++) {
+        const DisplayListCommand *command = (const DisplayListCommand *)&arena[offset];
+        DisplayListEntry &entry = entries[count];
+        entry.command = command;
+        entry.x0 = command->x0 < 0 ? 0 : command->x0;
+        entry.y0 = command->y0 < 0 ? 0 : command->y0;
+        entry.x1 = command->x1 < (int)display->GetWidth() ? command->x1 : display->GetWidth() - 1;
+        entry.y1 = command->y1 < (int)display->GetHeight() ? command->y1 : display->GetHeight() - 1;
+        entry.opaque = command->type != DisplayListLine;
+        // nothing of it on the screen
+        entry.live = entry.x0 <= entry.x1 && entry.y0 <= entry.y1;
+        offset += command->size;
+    }
+    assert(count == commandCount);
+
+    Cull();
+    Merge();
+    unsigned live = Sort();
+
+    for (unsigned i = 0; i < live; i++) {
+        Run(entries[order[i]]);
+    }
+}
+
+void DisplayList::Cull(void)
+{
+    for (unsigned i = 0; i < commandCount; i++) {
+        if (! entries[i].live) {
+            continue;
+        }
+        for (unsigned j = i + 1; j < commandCount; j++) {
+            if (entries[j].live && entries[j].opaque && Contains(entries[j], entries[i])) {
+                entries[i].live = FALSE;
+                culled++;
+                break;
+            }
+        }
+    }
+}
+
+void DisplayList::Merge(void)
+{
+    for (unsigned i = 0; i < commandCount; i++) {
+        DisplayListEntry &first = entries[i];
+        if (! first.live || first.command->type != DisplayListFill) {
+            continue;
+        }
+
+        for (unsigned j = i + 1; j < commandCount; j++) {
+            DisplayListEntry &second = entries[j];
+            if (! second.live || second.command->type != DisplayListFill
+                || second.command->fg != first.command->fg || ! FormRect(first, second)) {
+                continue;
+            }
+
+            // the second fill moves back to the first one, nothing in
+            // between may draw where it goes
+            boolean blocked = FALSE;
+            for (unsigned k = i + 1; k < j && ! blocked; k++) {
+                blocked = entries[k].live && Overlaps(entries[k], second);
+            }
+            if (blocked) {
+                continue;
+            }
+
+            first.x0 = first.x0 < second.x0 ? first.x0 : second.x0;
+            first.y0 = first.y0 < second.y0 ? first.y0 : second.y0;
+            first.x1 = first.x1 > second.x1 ? first.x1 : second.x1;
+            first.y1 = first.y1 > second.y1 ? first.y1 : second.y1;
+            second.live = FALSE;
+            merged++;
+        }
+    }
+}
+
+unsigned DisplayList::Sort(void)
+{
+    // Top to bottom, left to right, but a command never goes ahead of an
+    // earlier one it overlaps.
+    unsigned count = 0;
+    for (unsigned i = 0; i < commandCount; i++) {
+        if (entries[i].live) {
+            order[count++] = i;
+        }
+    }
+
+    for (unsigned n = 0; n < count; n++) {
+        unsigned best = n;
+        for (unsigned c = n; c < count; c++) {
+            const DisplayListEntry &candidate = entries[order[c]];
+            if (c != best && (candidate.y0 > entries[order[best]].y0
+                || (candidate.y0 == entries[order[best]].y0 && candidate.x0 >= entries[order[best]].x0))) {
+                continue;
+            }
+
+            boolean ready = TRUE;
+            for (unsigned k = n; k < count && ready; k++) {
+                ready = order[k] >= order[c] || ! Overlaps(entries[order[k]], candidate);
+            }
+            if (ready) {
+                best = c;
+            }
+        }
+
+        // keep the rest in recording order
+        unsigned index = order[best];
+        for (unsigned k = best; k > n; k--) {
+            order[k] = order[k - 1];
+        }
+        order[n] = index;
+    }
+
+    return count;
+}
+
+void DisplayList::Run(const DisplayListEntry &_entry)
+{
+    const DisplayListCommand &command = *_entry.command;
+    switch (command.type) {
+    case DisplayListFill:
+        // possibly grown by merging
+        FillClipped(_entry.x0, _entry.y0, _entry.x1, _entry.y1, command.fg);
+        break;
+    case DisplayListLine:
+        DrawLine(command);
+        break;
+    case DisplayListText:
+        DrawText(command);
+        break;
+    case DisplayListBlit:
+        DrawBlit(command);
+        break;
+    }
+}
+
+void DisplayList::FillClipped(int _x0, int _y0, int _x1, int _y1, u16 _color)
+{
+    _x0 = _x0 < 0 ? 0 : _x0;
+    _y0 = _y0 < 0 ? 0 : _y0;
+    if (_x0 > _x1 || _y0 > _y1) {
+        return;
+    }
+    display->FillRect(_x0, _y0, _x1 - _x0 + 1, _y1 - _y0 + 1, _color);
+}
+
+void DisplayList::DrawLine(const DisplayListCommand &_command)
+{
+    int x = _command.points[0];
+    int y = _command.points[1];
+    int x1 = _command.points[2];
+    int y1 = _command.points[3];
+    int dx = x1 > x ? x1 - x : x - x1;
+    int dy = y1 > y ? y1 - y : y - y1;
+    int sx = x < x1 ? 1 : -1;
+    int sy = y < y1 ? 1 : -1;
+
+    // every run of pixels on one row (or column) goes out as one window
+    if (dx >= dy) {
+        int error = dx / 2;
+        int start = x;
+        for (;;) {
+            boolean last = x == x1;
+            error -= dy;
+            if (last || error < 0) {
+                FillClipped(start < x ? start : x, y, start < x ? x : start, y, _command.fg);
+                if (last) {
+                    break;
+                }
+                y += sy;
+                error += dx;
+                start = x + sx;
+            }
+            x += sx;
+        }
+    } else {
+        int error = dy / 2;
+        int start = y;
+        for (;;) {
+            boolean last = y == y1;
+            error -= dx;
+            if (last || error < 0) {
+                FillClipped(x, start < y ? start : y, x, start < y ? y : start, _command.fg);
+                if (last) {
+                    break;
+                }
+                x += sx;
+                error += dy;
+                start = y + sy;
+            }
+            y += sy;
+        }
+    }
+}
+
+void DisplayList::DrawText(const DisplayListCommand &_command)
+{
+    const char *text = (const char *)(&_command + 1);
+    unsigned w = font.GetCharWidth();
+
+    int x0 = _command.x0 < 0 ? 0 : _command.x0;
+    int y0 = _command.y0 < 0 ? 0 : _command.y0;
+    int x1 = _command.x1 < (int)display->GetWidth() ? _command.x1 : display->GetWidth() - 1;
+    int y1 = _command.y1 < (int)display->GetHeight() ? _command.y1 : display->GetHeight() - 1;
+    if (x0 > x1 || y0 > y1) {
+        return;
+    }
+
+    display->SetXY(x0, x1, y0, y1);
+    for (int y = y0; y <= y1; y++) {
+        unsigned row = y - _command.y0;
+        for (int x = x0; x <= x1; x++) {
+            unsigned column = x - _command.x0;
+            char glyph = text[column / w];
+            lineBuffer[x - x0] = font.GetPixel(glyph, column % w, row) ? _command.fg : _command.bg;
+        }
+        display->WritePixels(lineBuffer, x1 - x0 + 1);
+    }
+}
+
+void DisplayList::DrawBlit(const DisplayListCommand &_command)
+{
+    const Image565 &image = *_command.image;
+
+    int x0 = _command.x0 < 0 ? 0 : _command.x0;
+    int y0 = _command.y0 < 0 ? 0 : _command.y0;
+    int x1 = _command.x1 < (int)display->GetWidth() ? _command.x1 : display->GetWidth() - 1;
+    int y1 = _command.y1 < (int)display->GetHeight() ? _command.y1 : display->GetHeight() - 1;
+    if (x0 > x1 || y0 > y1) {
+        return;
+    }
+
+    unsigned count = x1 - x0 + 1;
+    const u16 *src = &image.pixels[(y0 - _command.y0) * image.pitch + (x0 - _command.x0)];
+
+    display->SetXY(x0, x1, y0, y1);
+    if (count == image.pitch) {
+        // rows follow each other in memory
+        display->WritePixels(src, count * (y1 - y0 + 1));
+        return;
+    }
+    for (int y = y0; y <= y1; y++) {
+        display->WritePixels(src, count);
+        src += image.pitch;
+    }
+}
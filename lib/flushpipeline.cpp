@@ -0,0 +1,150 @@
+//
+// flushpipeline.cpp
+//
+// Display transfers on a second core, fed through lock free queues
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <excircles/flushpipeline.h>
+
+#ifdef ARM_ALLOW_MULTI_CORE
+
+#include <circle/logger.h>
+#include <circle/synchronize.h>
+#include <assert.h>
+
+static const char FromFlushPipeline[] = "flushpipeline";
+
+FlushPipeline::FlushPipeline(CMemorySystem *_memory, DisplayDevice *_display)
+    : CMultiCoreSupport(_memory),
+      display(_display),
+      inFlight(0)
+{
+    assert(display != 0);
+}
+
+FlushPipeline::~FlushPipeline(void)
+{
+    display = 0;
+}
+
+boolean FlushPipeline::Initialize(void)
+{
+    if (! CMultiCoreSupport::Initialize()) {
+        CLogger::Get()->Write(FromFlushPipeline, LogError, "Cannot start the secondary cores");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+boolean FlushPipeline::SubmitPixels(const u16 *_pixels, unsigned _x0, unsigned _x1,
+                                    unsigned _y0, unsigned _y1, void *_param)
+{
+    assert(ThisCore() != FLUSH_PIPELINE_CORE);
+    assert(_pixels != 0);
+    assert(_x0 <= _x1 && _y0 <= _y1);
+
+    // the completed queue must always have room for what is in flight
+    if (inFlight == FLUSH_PIPELINE_QUEUE_SIZE - 1) {
+        return FALSE;
+    }
+
+    FlushRequest request = { FlushRequestPixels, _pixels, 0, _x0, _x1, _y0, _y1, _param };
+    if (! submitted.Push(request)) {
+        return FALSE;
+    }
+    inFlight++;
+
+    return TRUE;
+}
+
+boolean FlushPipeline::SubmitList(DisplayList *_list, void *_param)
+{
+    assert(ThisCore() != FLUSH_PIPELINE_CORE);
+    assert(_list != 0);
+
+    if (inFlight == FLUSH_PIPELINE_QUEUE_SIZE - 1) {
+        return FALSE;
+    }
+
+    FlushRequest request = { FlushRequestList, 0, _list, 0, 0, 0, 0, _param };
+    if (! submitted.Push(request)) {
+        return FALSE;
+    }
+    inFlight++;
+
+    return TRUE;
+}
+
+boolean FlushPipeline::GetCompleted(FlushRequest *_request)
+{
+    assert(_request != 0);
+
+    if (! completed.Pop(_request)) {
+        return FALSE;
+    }
+    assert(inFlight > 0);
+    inFlight--;
+
+    return TRUE;
+}
+
+void FlushPipeline::Sync(void)
+{
+    while (completed.GetCount() != inFlight) {
+        // nothing to do but wait for the other core
+    }
+    DataMemBarrier();
+}
+
+void FlushPipeline::Run(unsigned _core)
+{
+    if (_core != FLUSH_PIPELINE_CORE) {
+        return;
+    }
+
+    CLogger::Get()->Write(FromFlushPipeline, LogDebug, "Flush worker running on core %u", _core);
+
+    FlushRequest request;
+    for (;;) {
+        if (! submitted.Pop(&request)) {
+            continue;
+        }
+
+        Execute(request);
+
+        // there is always room, see SubmitPixels()
+        boolean pushed = completed.Push(request);
+        assert(pushed);
+        (void)pushed;
+    }
+}
+
+void FlushPipeline::Execute(const FlushRequest &_request)
+{
+    switch (_request.type) {
+    case FlushRequestPixels:
+        display->SetXY(_request.x0, _request.x1, _request.y0, _request.y1);
+        display->WritePixels(_request.pixels,
+            (_request.x1 - _request.x0 + 1) * (_request.y1 - _request.y0 + 1));
+        break;
+    case FlushRequestList:
+        _request.list->Execute();
+        break;
+    }
+}
+
+#endif // ARM_ALLOW_MULTI_CORE
@@ -0,0 +1,144 @@
+//
+// framepacer.cpp
+//
+// Frame rate pacing with render and flush time accounting
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <circle/timer.h>
+#include <excircles/framepacer.h>
+#include <assert.h>
+
+FramePacer::FramePacer(unsigned _fps, unsigned _idleFps)
+    : render(0),
+      flush(0),
+      param(0),
+      period(1000000 / _fps),
+      idlePeriod(1000000 / _idleFps),
+      started(FALSE),
+      deadline(0),
+      idleDeadline(0),
+      idle(FALSE),
+      skipped(FALSE),
+      unchanged(0),
+      delivered(0),
+      dropped(0),
+      late(0),
+      renderTime(0),
+      flushTime(0),
+      maxFrameTime(0)
+{
+    assert(_fps > 0);
+    assert(_idleFps > 0 && _idleFps <= _fps);
+}
+
+FramePacer::~FramePacer(void)
+{
+    render = 0;
+    flush = 0;
+}
+
+void FramePacer::SetCallbacks(FramePacerRender *_render, FramePacerFlush *_flush, void *_param)
+{
+    assert(_render != 0);
+
+    render = _render;
+    flush = _flush;
+    param = _param;
+}
+
+boolean FramePacer::Tick(void)
+{
+    assert(render != 0);
+
+    unsigned now = CTimer::GetClockTicks();
+    if (! started) {
+        deadline = now;
+        started = TRUE;
+    }
+
+    unsigned current = idle ? idlePeriod : period;
+    // a periodic caller wakes up a little early now and then, that is
+    // still this frame and not the next one
+    if ((int)(now + current / 4 - (idle ? idleDeadline : deadline)) < 0) {
+        return FALSE;
+    }
+    if (idle) {
+        idleDeadline += idlePeriod;
+        if ((int)(now - idleDeadline) >= 0) {
+            idleDeadline = now + idlePeriod;
+        }
+    }
+
+    // full rate frame periods since the deadline, the first one is this
+    // frame; while idle the frames in between are skipped on purpose
+    unsigned frames = 1;
+    if ((int)(now - deadline) > 0) {
+        frames += (now - deadline) / period;
+    }
+    deadline += frames * period;
+    if (! skipped) {
+        dropped += frames - 1;
+    }
+
+    boolean changed = (*render)(frames, param);
+    unsigned rendered = CTimer::GetClockTicks();
+    renderTime = rendered - now;
+
+    flushTime = 0;
+    if (changed) {
+        if (flush != 0) {
+            (*flush)(param);
+            flushTime = CTimer::GetClockTicks() - rendered;
+        }
+        delivered++;
+    }
+
+    unsigned frameTime = renderTime + flushTime;
+    if (frameTime > maxFrameTime) {
+        maxFrameTime = frameTime;
+    }
+    if (frameTime > current) {
+        late++;
+    }
+
+    if (changed) {
+        // the next frame at the full rate, the deadline kept its phase
+        unchanged = 0;
+        idle = FALSE;
+    } else if (! idle && ++unchanged >= FRAME_PACER_IDLE_FRAMES) {
+        idle = TRUE;
+        idleDeadline = now + idlePeriod;
+    }
+    skipped = idle;
+
+    return TRUE;
+}
+
+void FramePacer::Wake(void)
+{
+    // the deadline is past, so the next Tick() renders and covers the
+    // time spent idle
+    unchanged = 0;
+    idle = FALSE;
+}
+
+void FramePacer::ResetStats(void)
+{
+    delivered = 0;
+    dropped = 0;
+    late = 0;
+    maxFrameTime = 0;
+}
@@ -0,0 +1,86 @@
+//
+// halfresfb.cpp
+//
+// Half resolution framebuffer, pixels are doubled on the way out
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <circle/logger.h>
+#include <excircles/halfresfb.h>
+#include <excircles/pixelformat.h>
+#include <assert.h>
+
+static const char FromHalfResFB[] = "halfresfb";
+
+// the format is picked once per row, the loops are specialized
+static void PackDoubled(DisplayPixelFormat _format, u8 *_dst, const u16 *_src, unsigned _count)
+{
+    switch (_format) {
+    case DisplayPixelFormatRGB565:
+        PackPixelsDoubled<PixelFormatRGB565>(_dst, _src, _count);
+        break;
+    case DisplayPixelFormatRGB666:
+        PackPixelsDoubled<PixelFormatRGB666>(_dst, _src, _count);
+        break;
+    case DisplayPixelFormatRGB888:
+        PackPixelsDoubled<PixelFormatRGB888>(_dst, _src, _count);
+        break;
+    }
+}
+
+HalfResFrameBuffer::HalfResFrameBuffer(DisplayDevice *_display)
+    : MemoryDisplayDevice(_display->GetWidth() / 2, _display->GetHeight() / 2),
+      display(_display),
+      format(_display->GetPixelFormat()),
+      lineBuffer(0)
+{
+    assert(display != 0);
+}
+
+HalfResFrameBuffer::~HalfResFrameBuffer(void)
+{
+    delete [] lineBuffer;
+    lineBuffer = 0;
+    display = 0;
+}
+
+boolean HalfResFrameBuffer::Initialize(void)
+{
+    lineBuffer = new u8[2 * width * display->GetBytesPerPixel()];
+    if (lineBuffer == 0) {
+        CLogger::Get()->Write(FromHalfResFB, LogError, "Cannot allocate the line buffer");
+        return FALSE;
+    }
+
+    return MemoryDisplayDevice::Initialize();
+}
+
+void HalfResFrameBuffer::Flush(void)
+{
+    if (! dirty || buffer == 0) {
+        return;
+    }
+
+    unsigned count = dirtyX1 - dirtyX0 + 1;
+    unsigned length = 2 * count * display->GetBytesPerPixel();
+    display->SetXY(2 * dirtyX0, 2 * dirtyX1 + 1, 2 * dirtyY0, 2 * dirtyY1 + 1);
+    for (unsigned y = dirtyY0; y <= dirtyY1; y++) {
+        PackDoubled(format, lineBuffer, &GetBuffer()[y * width + dirtyX0], count);
+        display->WriteRaw(lineBuffer, length);
+        display->WriteRaw(lineBuffer, length);
+    }
+
+    dirty = FALSE;
+}
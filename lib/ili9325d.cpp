@@ -29,7 +29,8 @@ static const char FromILI9325D[] = "ili9325d";
 
 ILI9325DDevice::ILI9325DDevice(u8 _db0, u8 _db1, u8 _db2, u8 _db3, u8 _db4, u8 _db5, u8 _db6, u8 _db7,
                      u8 _cs, u8 _wr, u8 _rs, u8 _rst)
-    : db{{_db0, GPIOModeOutput},
+    : DisplayDevice(LCD_WIDTH, LCD_HEIGHT),
+      db{{_db0, GPIOModeOutput},
          {_db1, GPIOModeOutput},
          {_db2, GPIOModeOutput},
          {_db3, GPIOModeOutput},
@@ -182,22 +183,42 @@ void ILI9325DDevice::SetXY(unsigned _x0, unsigned _x1, unsigned _y0, unsigned _y
     WriteCommand(0x22);
 }
 
-void ILI9325DDevice::Paint(unsigned _color)
+void ILI9325DDevice::WritePixels(const u16 *_pixels, unsigned _count)
 {
-    SetXY(0, LCD_WIDTH-1, 0, LCD_HEIGHT-1);
-    for(unsigned i = 0; i < LCD_HEIGHT; i++) {
-        for (unsigned j = 0; j < LCD_WIDTH; j++) {
-            WriteData(_color);
-        }
+    for (unsigned i = 0; i < _count; i++) {
+        WriteData(_pixels[i]);
     }
 }
 
-void ILI9325DDevice::Clear(void)
+void ILI9325DDevice::FillPixels(u16 _color, unsigned _count)
 {
-    SetXY(0, LCD_WIDTH-1, 0, LCD_HEIGHT-1);
-    for(unsigned i = 0; i < LCD_HEIGHT; i++) {
-        for(unsigned j = 0; j < LCD_WIDTH; j++) {
-            WriteData(0x0000);
+    for (unsigned i = 0; i < _count; i++) {
+        WriteData(_color);
+    }
+}
+
+void ILI9325DDevice::WriteRaw(const u8 *_data, unsigned _length)
+{
+    rs.Write(HIGH);
+    cs.Write(LOW);
+    // one strobe per byte, high byte of each pixel first
+    for (unsigned i = 0; i < _length; i++) {
+        for (unsigned j = 0; j < 8; j++) {
+            db[j].Write((_data[i] & (1 << j)) ? HIGH : LOW);
         }
+        wr.Write(LOW);
+        wr.Write(HIGH);
     }
+    cs.Write(HIGH);
+}
+
+void ILI9325DDevice::Paint(unsigned _color)
+{
+    SetXY(0, LCD_WIDTH-1, 0, LCD_HEIGHT-1);
+    FillPixels(_color, LCD_WIDTH * LCD_HEIGHT);
+}
+
+void ILI9325DDevice::Clear(void)
+{
+    Paint(0x0000);
 }
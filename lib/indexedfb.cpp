@@ -0,0 +1,321 @@
+//
+// indexedfb.cpp
+//
+// Palette indexed framebuffer with 8, 4, 2 or 1 bits per pixel
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <circle/logger.h>
+#include <circle/util.h>
+#include <excircles/indexedfb.h>
+#include <excircles/pixelformat.h>
+#include <assert.h>
+
+static const char FromIndexedFB[] = "indexedfb";
+
+static void StoreColor(DisplayPixelFormat _format, u8 *_dst, u16 _color)
+{
+    switch (_format) {
+    case DisplayPixelFormatRGB565:
+        PixelFormatRGB565::Store(_dst, _color);
+        break;
+    case DisplayPixelFormatRGB666:
+        PixelFormatRGB666::Store(_dst, _color);
+        break;
+    case DisplayPixelFormatRGB888:
+        PixelFormatRGB888::Store(_dst, _color);
+        break;
+    }
+}
+
+// two pixels per byte with one lookup of the pair table
+template <class Format>
+static void ExpandPairs(u8 *_dst, const u8 *_row, unsigned _x, unsigned _count,
+                        const u8 *_palette, const u8 *_pairs)
+{
+    const unsigned size = Format::BytesPerPixel;
+
+    _row += _x / 2;
+    if (_x & 1) {
+        ExpandIndexed<Format, PixelFormatIndexed<4> >(_dst, _row++, 1, 1, _palette);
+        _dst += size;
+        _count--;
+    }
+    for (; _count >= 2; _count -= 2) {
+        const u8 *pair = &_pairs[*_row++ * 2 * size];
+        for (unsigned k = 0; k < 2 * size; k++) {
+            *_dst++ = pair[k];
+        }
+    }
+    if (_count != 0) {
+        ExpandIndexed<Format, PixelFormatIndexed<4> >(_dst, _row, 0, 1, _palette);
+    }
+}
+
+// the formats are picked once per row, the loops are specialized
+template <class Format>
+static void ExpandRow(unsigned _bits, u8 *_dst, const u8 *_row, unsigned _x, unsigned _count,
+                      const u8 *_palette, const u8 *_pairs)
+{
+    switch (_bits) {
+    case 1:
+        ExpandIndexed<Format, PixelFormatIndexed<1> >(_dst, _row, _x, _count, _palette);
+        break;
+    case 2:
+        ExpandIndexed<Format, PixelFormatIndexed<2> >(_dst, _row, _x, _count, _palette);
+        break;
+    case 4:
+        ExpandPairs<Format>(_dst, _row, _x, _count, _palette, _pairs);
+        break;
+    default:
+        ExpandIndexed<Format, PixelFormatIndexed<8> >(_dst, _row, _x, _count, _palette);
+        break;
+    }
+}
+
+IndexedFrameBuffer::IndexedFrameBuffer(DisplayDevice *_display, unsigned _bits)
+    : display(_display),
+      format(_display->GetPixelFormat()),
+      bytesPerPixel(_display->GetBytesPerPixel()),
+      bits(_bits),
+      pitch(0),
+      buffer(0),
+      wireRow(0),
+      pairs(0),
+      dirty(FALSE),
+      dirtyX0(0),
+      dirtyY0(0),
+      dirtyX1(0),
+      dirtyY1(0)
+{
+    assert(display != 0);
+    assert(bits == 1 || bits == 2 || bits == 4 || bits == 8);
+    assert(bytesPerPixel <= INDEXED_FB_MAX_BYTES_PER_PIXEL);
+
+    for (unsigned i = 0; i < 256; i++) {
+        palette[i] = 0x0000;
+    }
+    // black and white is a sane default for 1 bit
+    palette[1] = 0xFFFF;
+}
+
+IndexedFrameBuffer::~IndexedFrameBuffer(void)
+{
+    delete [] buffer;
+    delete [] wireRow;
+    delete [] pairs;
+    display = 0;
+}
+
+boolean IndexedFrameBuffer::Initialize(void)
+{
+    pitch = (display->GetWidth() * bits + 7) / 8;
+    buffer = new u8[pitch * display->GetHeight()];
+    wireRow = new u8[display->GetWidth() * bytesPerPixel];
+    if (bits == 4) {
+        pairs = new u8[256 * 2 * bytesPerPixel];
+    }
+    if (buffer == 0 || wireRow == 0 || (bits == 4 && pairs == 0)) {
+        CLogger::Get()->Write(FromIndexedFB, LogError, "Cannot allocate the framebuffer");
+        return FALSE;
+    }
+
+    memset(buffer, 0, pitch * display->GetHeight());
+    SetPalette(palette, GetColors());
+    return TRUE;
+}
+
+void IndexedFrameBuffer::SetPalette(const u16 *_colors, unsigned _count, unsigned _first)
+{
+    assert(_colors != 0);
+    assert(_first + _count <= GetColors());
+
+    for (unsigned i = 0; i < _count; i++) {
+        palette[_first + i] = _colors[i];
+        StoreColor(format, &wirePalette[(_first + i) * bytesPerPixel], _colors[i]);
+    }
+
+    if (pairs != 0) {
+        for (unsigned i = 0; i < 256; i++) {
+            // the left pixel first, as it goes out
+            u8 *pair = &pairs[i * 2 * bytesPerPixel];
+            memcpy(pair, &wirePalette[(i >> 4) * bytesPerPixel], bytesPerPixel);
+            memcpy(pair + bytesPerPixel, &wirePalette[(i & 0xF) * bytesPerPixel], bytesPerPixel);
+        }
+    }
+
+    MarkDirty(0, 0, display->GetWidth(), display->GetHeight());
+}
+
+void IndexedFrameBuffer::SetPaletteEntry(unsigned _index, u16 _color)
+{
+    SetPalette(&_color, 1, _index);
+}
+
+void IndexedFrameBuffer::DrawPixel(unsigned _x, unsigned _y, u8 _index)
+{
+    if (_x >= display->GetWidth() || _y >= display->GetHeight()) {
+        return;
+    }
+    assert(_index < GetColors());
+
+    SetIndex(&buffer[_y * pitch], _x, _index);
+    MarkDirty(_x, _y, 1, 1);
+}
+
+u8 IndexedFrameBuffer::GetPixel(unsigned _x, unsigned _y) const
+{
+    assert(_x < display->GetWidth() && _y < display->GetHeight());
+
+    const u8 *row = &buffer[_y * pitch];
+    switch (bits) {
+    case 1:
+        return PixelFormatIndexed<1>::Get(row, _x);
+    case 2:
+        return PixelFormatIndexed<2>::Get(row, _x);
+    case 4:
+        return PixelFormatIndexed<4>::Get(row, _x);
+    }
+    return PixelFormatIndexed<8>::Get(row, _x);
+}
+
+void IndexedFrameBuffer::FillRect(unsigned _x, unsigned _y, unsigned _width, unsigned _height, u8 _index)
+{
+    if (_x >= display->GetWidth() || _y >= display->GetHeight()) {
+        return;
+    }
+    if (_width > display->GetWidth() - _x) {
+        _width = display->GetWidth() - _x;
+    }
+    if (_height > display->GetHeight() - _y) {
+        _height = display->GetHeight() - _y;
+    }
+    if (_width == 0 || _height == 0) {
+        return;
+    }
+    assert(_index < GetColors());
+
+    // whole bytes in the middle of each row are set at once
+    unsigned perByte = 8 / bits;
+    // the index repeated in every pixel of a byte
+    u8 fill = (u8)(_index * (0xFF / (GetColors() - 1)));
+    for (unsigned j = 0; j < _height; j++) {
+        u8 *row = &buffer[(_y + j) * pitch];
+        unsigned x = _x;
+        unsigned end = _x + _width;
+        while (x < end && (x % perByte) != 0) {
+            SetIndex(row, x++, _index);
+        }
+        unsigned bytes = (end - x) / perByte;
+        memset(&row[x / perByte], fill, bytes);
+        x += bytes * perByte;
+        while (x < end) {
+            SetIndex(row, x++, _index);
+        }
+    }
+
+    MarkDirty(_x, _y, _width, _height);
+}
+
+void IndexedFrameBuffer::Clear(u8 _index)
+{
+    FillRect(0, 0, display->GetWidth(), display->GetHeight(), _index);
+}
+
+void IndexedFrameBuffer::MarkDirty(unsigned _x, unsigned _y, unsigned _width, unsigned _height)
+{
+    if (_width == 0 || _height == 0) {
+        return;
+    }
+
+    unsigned x1 = _x + _width - 1;
+    unsigned y1 = _y + _height - 1;
+    if (x1 >= display->GetWidth()) {
+        x1 = display->GetWidth() - 1;
+    }
+    if (y1 >= display->GetHeight()) {
+        y1 = display->GetHeight() - 1;
+    }
+    if (_x > x1 || _y > y1) {
+        return;
+    }
+
+    if (! dirty) {
+        dirtyX0 = _x;
+        dirtyY0 = _y;
+        dirtyX1 = x1;
+        dirtyY1 = y1;
+        dirty = TRUE;
+        return;
+    }
+
+    if (_x < dirtyX0) {
+        dirtyX0 = _x;
+    }
+    if (_y < dirtyY0) {
+        dirtyY0 = _y;
+    }
+    if (x1 > dirtyX1) {
+        dirtyX1 = x1;
+    }
+    if (y1 > dirtyY1) {
+        dirtyY1 = y1;
+    }
+}
+
+void IndexedFrameBuffer::Flush(void)
+{
+    if (! dirty || buffer == 0) {
+        return;
+    }
+
+    unsigned count = dirtyX1 - dirtyX0 + 1;
+    display->SetXY(dirtyX0, dirtyX1, dirtyY0, dirtyY1);
+    for (unsigned y = dirtyY0; y <= dirtyY1; y++) {
+        const u8 *row = &buffer[y * pitch];
+        switch (format) {
+        case DisplayPixelFormatRGB565:
+            ExpandRow<PixelFormatRGB565>(bits, wireRow, row, dirtyX0, count, wirePalette, pairs);
+            break;
+        case DisplayPixelFormatRGB666:
+            ExpandRow<PixelFormatRGB666>(bits, wireRow, row, dirtyX0, count, wirePalette, pairs);
+            break;
+        case DisplayPixelFormatRGB888:
+            ExpandRow<PixelFormatRGB888>(bits, wireRow, row, dirtyX0, count, wirePalette, pairs);
+            break;
+        }
+        display->WriteRaw(wireRow, count * bytesPerPixel);
+    }
+
+    dirty = FALSE;
+}
+
+void IndexedFrameBuffer::SetIndex(u8 *_row, unsigned _x, u8 _index)
+{
+    switch (bits) {
+    case 1:
+        PixelFormatIndexed<1>::Set(_row, _x, _index);
+        break;
+    case 2:
+        PixelFormatIndexed<2>::Set(_row, _x, _index);
+        break;
+    case 4:
+        PixelFormatIndexed<4>::Set(_row, _x, _index);
+        break;
+    default:
+        PixelFormatIndexed<8>::Set(_row, _x, _index);
+        break;
+    }
+}
@@ -0,0 +1,215 @@
+//
+// linerenderer.cpp
+//
+// Renders the screen a few lines at a time without a framebuffer
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <circle/logger.h>
+#include <excircles/linerenderer.h>
+#include <assert.h>
+
+static const char FromLineRenderer[] = "linerenderer";
+
+// channels of a RGB565 color in 16.16 fixed point
+struct GradientChannels
+{
+    s32 r;
+    s32 g;
+    s32 b;
+};
+
+static inline void GradientStart(GradientChannels &_start, GradientChannels &_step,
+                                 u16 _from, u16 _to, unsigned _length)
+{
+    _start.r = (s32)(_from >> 11) << 16;
+    _start.g = (s32)((_from >> 5) & 0x3F) << 16;
+    _start.b = (s32)(_from & 0x1F) << 16;
+
+    s32 steps = _length > 1 ? (s32)_length - 1 : 1;
+    _step.r = (((s32)(_to >> 11) << 16) - _start.r) / steps;
+    _step.g = (((s32)((_to >> 5) & 0x3F) << 16) - _start.g) / steps;
+    _step.b = (((s32)(_to & 0x1F) << 16) - _start.b) / steps;
+}
+
+static inline u16 GradientColor(const GradientChannels &_c)
+{
+    return (u16)((((_c.r + 0x8000) >> 16) << 11) | (((_c.g + 0x8000) >> 16) << 5)
+        | ((_c.b + 0x8000) >> 16));
+}
+
+LineRenderer::LineRenderer(DisplayDevice *_display)
+    : display(_display),
+      nextBuffer(0),
+      background(0x0000),
+      callback(0),
+      callbackParam(0),
+      sceneCount(0)
+{
+    assert(display != 0);
+
+    for (unsigned i = 0; i < LINE_RENDERER_BUFFERS; i++) {
+        buffers[i] = 0;
+    }
+}
+
+LineRenderer::~LineRenderer(void)
+{
+    for (unsigned i = 0; i < LINE_RENDERER_BUFFERS; i++) {
+        delete [] buffers[i];
+    }
+    display = 0;
+}
+
+boolean LineRenderer::Initialize(void)
+{
+    for (unsigned i = 0; i < LINE_RENDERER_BUFFERS; i++) {
+        buffers[i] = new u16[display->GetWidth() * LINE_RENDERER_LINES];
+        if (buffers[i] == 0) {
+            CLogger::Get()->Write(FromLineRenderer, LogError, "Cannot allocate the line buffers");
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+void LineRenderer::SetBackground(u16 _color)
+{
+    background = _color;
+}
+
+void LineRenderer::RegisterCallback(LineRendererCallback *_callback, void *_param)
+{
+    callback = _callback;
+    callbackParam = _param;
+}
+
+void LineRenderer::ClearScene(void)
+{
+    sceneCount = 0;
+}
+
+boolean LineRenderer::AddRect(int _x, int _y, unsigned _width, unsigned _height, u16 _color)
+{
+    LinePrimitive primitive = {LinePrimitiveRect, _x, _y, _width, _height, _color, _color};
+    return Add(primitive);
+}
+
+boolean LineRenderer::AddGradient(int _x, int _y, unsigned _width, unsigned _height,
+                                  u16 _from, u16 _to, boolean _vertical)
+{
+    LinePrimitive primitive = {_vertical ? LinePrimitiveGradientV : LinePrimitiveGradientH,
+        _x, _y, _width, _height, _from, _to};
+    return Add(primitive);
+}
+
+boolean LineRenderer::Add(const LinePrimitive &_primitive)
+{
+    if (sceneCount == LINE_RENDERER_MAX_PRIMITIVES) {
+        CLogger::Get()->Write(FromLineRenderer, LogError, "Scene is full");
+        return FALSE;
+    }
+
+    scene[sceneCount++] = _primitive;
+    return TRUE;
+}
+
+void LineRenderer::Render(void)
+{
+    if (buffers[0] == 0) {
+        return;
+    }
+
+    unsigned width = display->GetWidth();
+    unsigned height = display->GetHeight();
+
+    display->SetXY(0, width-1, 0, height-1);
+    for (unsigned y = 0; y < height; y += LINE_RENDERER_LINES) {
+        unsigned lines = height - y < LINE_RENDERER_LINES ? height - y : LINE_RENDERER_LINES;
+        u16 *buffer = buffers[nextBuffer];
+        nextBuffer = (nextBuffer + 1) % LINE_RENDERER_BUFFERS;
+
+        for (unsigned j = 0; j < lines; j++) {
+            RenderLine(y + j, &buffer[j * width]);
+        }
+        display->WritePixels(buffer, lines * width);
+    }
+}
+
+void LineRenderer::RenderLine(unsigned _y, u16 *_line)
+{
+    unsigned width = display->GetWidth();
+
+    for (unsigned i = 0; i < width; i++) {
+        _line[i] = background;
+    }
+
+    for (unsigned p = 0; p < sceneCount; p++) {
+        const LinePrimitive &primitive = scene[p];
+        int row = (int)_y - primitive.y;
+        if (row < 0 || row >= (int)primitive.height) {
+            continue;
+        }
+
+        int x0 = primitive.x < 0 ? 0 : primitive.x;
+        int x1 = primitive.x + (int)primitive.width;
+        if (x1 > (int)width) {
+            x1 = width;
+        }
+        if (x0 >= x1) {
+            continue;
+        }
+
+        GradientChannels c, step;
+        switch (primitive.type) {
+        case LinePrimitiveRect:
+            for (int i = x0; i < x1; i++) {
+                _line[i] = primitive.color;
+            }
+            break;
+
+        case LinePrimitiveGradientV:
+            GradientStart(c, step, primitive.color, primitive.color2, primitive.height);
+            c.r += step.r * row;
+            c.g += step.g * row;
+            c.b += step.b * row;
+            {
+                u16 color = GradientColor(c);
+                for (int i = x0; i < x1; i++) {
+                    _line[i] = color;
+                }
+            }
+            break;
+
+        case LinePrimitiveGradientH:
+            GradientStart(c, step, primitive.color, primitive.color2, primitive.width);
+            c.r += step.r * (x0 - primitive.x);
+            c.g += step.g * (x0 - primitive.x);
+            c.b += step.b * (x0 - primitive.x);
+            for (int i = x0; i < x1; i++) {
+                _line[i] = GradientColor(c);
+                c.r += step.r;
+                c.g += step.g;
+                c.b += step.b;
+            }
+            break;
+        }
+    }
+
+    if (callback != 0) {
+        (*callback)(_y, _line, width, callbackParam);
+    }
+}
@@ -0,0 +1,203 @@
+//
+// memorydisplay.cpp
+//
+// Display device drawing into memory, base of the framebuffers
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <circle/logger.h>
+#include <circle/util.h>
+#include <excircles/memorydisplay.h>
+#include <assert.h>
+
+static const char FromMemoryDisplay[] = "memorydisplay";
+
+MemoryDisplayDevice::MemoryDisplayDevice(unsigned _width, unsigned _height,
+                                         unsigned _bytesPerPixel)
+    : DisplayDevice(_width, _height),
+      bytesPerPixel(_bytesPerPixel),
+      pitch(_width * _bytesPerPixel),
+      memory(0),
+      buffer(0),
+      windowX0(0),
+      windowX1(0),
+      windowY0(0),
+      windowY1(0),
+      cursorX(0),
+      cursorY(0),
+      dirty(FALSE),
+      dirtyX0(0),
+      dirtyY0(0),
+      dirtyX1(0),
+      dirtyY1(0)
+{
+    assert(bytesPerPixel > 0);
+}
+
+MemoryDisplayDevice::~MemoryDisplayDevice(void)
+{
+    delete [] memory;
+    memory = 0;
+    buffer = 0;
+}
+
+boolean MemoryDisplayDevice::Initialize(void)
+{
+    // whole cache lines, so cleaning the cache for DMA touches nothing else
+    unsigned size = (pitch * height + MEMORY_DISPLAY_ALIGN-1) & ~(MEMORY_DISPLAY_ALIGN-1);
+
+    memory = new u8[size + MEMORY_DISPLAY_ALIGN-1];
+    if (memory == 0) {
+        CLogger::Get()->Write(FromMemoryDisplay, LogError, "Cannot allocate %u x %u framebuffer",
+                              width, height);
+        return FALSE;
+    }
+    buffer = (u8 *)(((uintptr)memory + MEMORY_DISPLAY_ALIGN-1) & ~(uintptr)(MEMORY_DISPLAY_ALIGN-1));
+
+    memset(buffer, 0, size);
+    // the panel content is unknown
+    MarkDirty(0, 0, width, height);
+
+    return TRUE;
+}
+
+void MemoryDisplayDevice::SetXY(unsigned _x0, unsigned _x1, unsigned _y0, unsigned _y1)
+{
+    assert(_x0 <= _x1 && _y0 <= _y1);
+    assert(_x1 < width && _y1 < height);
+
+    windowX0 = _x0;
+    windowX1 = _x1;
+    windowY0 = _y0;
+    windowY1 = _y1;
+    cursorX = _x0;
+    cursorY = _y0;
+
+    AddDirty(_x0, _y0, _x1, _y1);
+}
+
+unsigned MemoryDisplayDevice::GetRun(unsigned _count) const
+{
+    unsigned n = windowX1 - cursorX + 1;
+    return n < _count ? n : _count;
+}
+
+void MemoryDisplayDevice::Advance(unsigned _count)
+{
+    // wrap around like the controllers do
+    cursorX += _count;
+    if (cursorX > windowX1) {
+        cursorX = windowX0;
+        cursorY = cursorY < windowY1 ? cursorY + 1 : windowY0;
+    }
+}
+
+void MemoryDisplayDevice::WritePixels(const u16 *_pixels, unsigned _count)
+{
+    assert(buffer != 0);
+
+    while (_count > 0) {
+        unsigned n = GetRun(_count);
+        StorePixels(GetAddress(cursorX, cursorY), _pixels, n);
+        _pixels += n;
+        _count -= n;
+        Advance(n);
+    }
+}
+
+void MemoryDisplayDevice::FillPixels(u16 _color, unsigned _count)
+{
+    assert(buffer != 0);
+
+    while (_count > 0) {
+        unsigned n = GetRun(_count);
+        StoreFill(GetAddress(cursorX, cursorY), _color, n);
+        _count -= n;
+        Advance(n);
+    }
+}
+
+void MemoryDisplayDevice::DrawPixel(unsigned _x, unsigned _y, u16 _color)
+{
+    assert(buffer != 0);
+    if (_x >= width || _y >= height) {
+        return;
+    }
+
+    StorePixels(GetAddress(_x, _y), &_color, 1);
+    AddDirty(_x, _y, _x, _y);
+}
+
+u16 MemoryDisplayDevice::GetPixel(unsigned _x, unsigned _y) const
+{
+    assert(buffer != 0);
+    assert(_x < width && _y < height);
+
+    return LoadPixel(GetAddress(_x, _y));
+}
+
+void MemoryDisplayDevice::MarkDirty(unsigned _x, unsigned _y, unsigned _width, unsigned _height)
+{
+    if (_x >= width || _y >= height || _width == 0 || _height == 0) {
+        return;
+    }
+    unsigned x1 = _x + _width - 1 < width ? _x + _width - 1 : width - 1;
+    unsigned y1 = _y + _height - 1 < height ? _y + _height - 1 : height - 1;
+
+    AddDirty(_x, _y, x1, y1);
+}
+
+void MemoryDisplayDevice::StorePixels(u8 *_dst, const u16 *_pixels, unsigned _count)
+{
+    memcpy(_dst, _pixels, _count * sizeof *_pixels);
+}
+
+void MemoryDisplayDevice::StoreFill(u8 *_dst, u16 _color, unsigned _count)
+{
+    u16 *dst = (u16 *)_dst;
+    for (unsigned i = 0; i < _count; i++) {
+        dst[i] = _color;
+    }
+}
+
+u16 MemoryDisplayDevice::LoadPixel(const u8 *_src) const
+{
+    return *(const u16 *)_src;
+}
+
+void MemoryDisplayDevice::AddDirty(unsigned _x0, unsigned _y0, unsigned _x1, unsigned _y1)
+{
+    if (! dirty) {
+        dirtyX0 = _x0;
+        dirtyY0 = _y0;
+        dirtyX1 = _x1;
+        dirtyY1 = _y1;
+        dirty = TRUE;
+        return;
+    }
+
+    if (_x0 < dirtyX0) {
+        dirtyX0 = _x0;
+    }
+    if (_y0 < dirtyY0) {
+        dirtyY0 = _y0;
+    }
+    if (_x1 > dirtyX1) {
+        dirtyX1 = _x1;
+    }
+    if (_y1 > dirtyY1) {
+        dirtyY1 = _y1;
+    }
+}
@@ -0,0 +1,117 @@
+//
+// nativefb.cpp
+//
+// Framebuffer kept in the wire format of the display
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <circle/util.h>
+#include <excircles/nativefb.h>
+#include <excircles/pixelformat.h>
+#include <assert.h>
+
+// the format is picked once per row, the loops are specialized
+static void Pack(DisplayPixelFormat _format, u8 *_dst, const u16 *_src, unsigned _count)
+{
+    switch (_format) {
+    case DisplayPixelFormatRGB565:
+        PackPixels<PixelFormatRGB565>(_dst, _src, _count);
+        break;
+    case DisplayPixelFormatRGB666:
+        PackPixels<PixelFormatRGB666>(_dst, _src, _count);
+        break;
+    case DisplayPixelFormatRGB888:
+        PackPixels<PixelFormatRGB888>(_dst, _src, _count);
+        break;
+    }
+}
+
+static void Fill(DisplayPixelFormat _format, u8 *_dst, u16 _color, unsigned _count)
+{
+    switch (_format) {
+    case DisplayPixelFormatRGB565:
+        PackFill<PixelFormatRGB565>(_dst, _color, _count);
+        break;
+    case DisplayPixelFormatRGB666:
+        PackFill<PixelFormatRGB666>(_dst, _color, _count);
+        break;
+    case DisplayPixelFormatRGB888:
+        PackFill<PixelFormatRGB888>(_dst, _color, _count);
+        break;
+    }
+}
+
+NativeFrameBuffer::NativeFrameBuffer(DisplayDevice *_display)
+    : MemoryDisplayDevice(_display->GetWidth(), _display->GetHeight(),
+                          _display->GetBytesPerPixel()),
+      display(_display),
+      format(_display->GetPixelFormat())
+{
+    assert(display != 0);
+}
+
+NativeFrameBuffer::~NativeFrameBuffer(void)
+{
+    display = 0;
+}
+
+void NativeFrameBuffer::StorePixels(u8 *_dst, const u16 *_pixels, unsigned _count)
+{
+    Pack(format, _dst, _pixels, _count);
+}
+
+void NativeFrameBuffer::StoreFill(u8 *_dst, u16 _color, unsigned _count)
+{
+    Fill(format, _dst, _color, _count);
+}
+
+u16 NativeFrameBuffer::LoadPixel(const u8 *_src) const
+{
+    switch (format) {
+    case DisplayPixelFormatRGB666:
+        return PixelFormatRGB666::Load(_src);
+    case DisplayPixelFormatRGB888:
+        return PixelFormatRGB888::Load(_src);
+    default:
+        return PixelFormatRGB565::Load(_src);
+    }
+}
+
+void NativeFrameBuffer::WriteRaw(const u8 *_data, unsigned _length)
+{
+    assert(buffer != 0);
+    assert(_length % bytesPerPixel == 0);
+
+    unsigned count = _length / bytesPerPixel;
+    while (count > 0) {
+        unsigned n = GetRun(count);
+        memcpy(GetAddress(cursorX, cursorY), _data, n * bytesPerPixel);
+        _data += n * bytesPerPixel;
+        count -= n;
+        Advance(n);
+    }
+}
+
+void NativeFrameBuffer::Flush(void)
+{
+    if (! dirty || buffer == 0) {
+        return;
+    }
+
+    display->SetXY(0, width-1, dirtyY0, dirtyY1);
+    display->WriteRaw(&buffer[dirtyY0 * pitch], (dirtyY1 - dirtyY0 + 1) * pitch);
+
+    dirty = FALSE;
+}
@@ -0,0 +1,142 @@
+//
+// panelgroup.cpp
+//
+// Several display panels driven as one large canvas
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <circle/logger.h>
+#include <excircles/panelgroup.h>
+#include <assert.h>
+
+static const char FromPanelGroup[] = "panelgroup";
+
+PanelGroup::PanelGroup(unsigned _width, unsigned _height)
+    : MemoryDisplayDevice(_width, _height),
+      panelCount(0)
+{
+}
+
+PanelGroup::~PanelGroup(void)
+{
+}
+
+boolean PanelGroup::AddPanel(QueuedDisplayDevice *_panel, unsigned _x, unsigned _y)
+{
+    assert(_panel != 0);
+
+    if (panelCount == PANEL_GROUP_MAX_PANELS) {
+        CLogger::Get()->Write(FromPanelGroup, LogError, "No room for another panel");
+        return FALSE;
+    }
+    if (_x + _panel->GetWidth() > width || _y + _panel->GetHeight() > height) {
+        CLogger::Get()->Write(FromPanelGroup, LogError, "Panel at %u, %u is off the canvas",
+                              _x, _y);
+        return FALSE;
+    }
+
+    panels[panelCount].device = _panel;
+    panels[panelCount].x = _x;
+    panels[panelCount].y = _y;
+    panelCount++;
+
+    return TRUE;
+}
+
+void PanelGroup::Service(void)
+{
+    for (unsigned i = 0; i < panelCount; i++) {
+        SPIQueue *queue = panels[i].device->GetQueue();
+        if (queue != 0) {
+            queue->Poll();
+        }
+    }
+}
+
+void PanelGroup::Flush(void)
+{
+    if (! dirty || buffer == 0) {
+        return;
+    }
+
+    // the changed area clipped to each panel, in canvas coordinates
+    unsigned x0[PANEL_GROUP_MAX_PANELS];
+    unsigned x1[PANEL_GROUP_MAX_PANELS];
+    unsigned y0[PANEL_GROUP_MAX_PANELS];
+    unsigned rows[PANEL_GROUP_MAX_PANELS];
+    unsigned maxRows = 0;
+
+    for (unsigned i = 0; i < panelCount; i++) {
+        const PanelGroupPanel *panel = &panels[i];
+        QueuedDisplayDevice *device = panel->device;
+        unsigned px1 = panel->x + device->GetWidth() - 1;
+        unsigned py1 = panel->y + device->GetHeight() - 1;
+
+        rows[i] = 0;
+        if (dirtyX1 < panel->x || dirtyX0 > px1 || dirtyY1 < panel->y || dirtyY0 > py1) {
+            continue;
+        }
+        x0[i] = dirtyX0 > panel->x ? dirtyX0 : panel->x;
+        x1[i] = dirtyX1 < px1 ? dirtyX1 : px1;
+        y0[i] = dirtyY0 > panel->y ? dirtyY0 : panel->y;
+        unsigned y1 = dirtyY1 < py1 ? dirtyY1 : py1;
+        rows[i] = y1 - y0[i] + 1;
+        if (rows[i] > maxRows) {
+            maxRows = rows[i];
+        }
+
+        unsigned wx0 = x0[i] - panel->x;
+        unsigned wx1 = x1[i] - panel->x;
+        unsigned wy0 = y0[i] - panel->y;
+        unsigned wy1 = y1 - panel->y;
+        if (device->GetQueue() != 0) {
+            while (! device->SetXYAsync(wx0, wx1, wy0, wy1)) {
+                Service();
+            }
+        } else {
+            device->SetXY(wx0, wx1, wy0, wy1);
+        }
+    }
+
+    // one row of every panel in turn, so each queue always has work
+    for (unsigned row = 0; row < maxRows; row++) {
+        for (unsigned i = 0; i < panelCount; i++) {
+            if (row >= rows[i]) {
+                continue;
+            }
+            QueuedDisplayDevice *device = panels[i].device;
+            const u16 *src = &GetBuffer()[(y0[i] + row) * width + x0[i]];
+            unsigned count = x1[i] - x0[i] + 1;
+            if (device->GetQueue() != 0) {
+                while (! device->WritePixelsAsync(src, count)) {
+                    Service();
+                }
+            } else {
+                device->WritePixels(src, count);
+            }
+        }
+    }
+
+    // the buffer must not change under the transfers, and the panels show
+    // the new frame together
+    for (unsigned i = 0; i < panelCount; i++) {
+        SPIQueue *queue = panels[i].device->GetQueue();
+        if (queue != 0) {
+            queue->Sync();
+        }
+    }
+
+    dirty = FALSE;
+}
@@ -0,0 +1,135 @@
+//
+// pixelconvert.cpp
+//
+// Pixel format conversion and blending kernels
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <excircles/pixelconvert.h>
+#include <excircles/rgb565.h>
+#include <assert.h>
+#ifdef PIXEL_CONVERT_NEON
+#include <arm_neon.h>
+#endif
+
+// The NEON loops handle 8 pixels per iteration and leave the remainder
+// to the scalar code that follows them.
+
+void PixelConvert::RGB888ToRGB565(u16 *_dst, const u32 *_src, unsigned _count)
+{
+    assert(_dst != 0 && _src != 0);
+
+#ifdef PIXEL_CONVERT_NEON
+    for (; _count >= 8; _count -= 8, _src += 8, _dst += 8) {
+        // bytes of 0x00RRGGBB in memory are B, G, R, 0
+        uint8x8x4_t bgrx = vld4_u8((const u8 *)_src);
+        uint16x8_t pixel = vshll_n_u8(bgrx.val[2], 8);
+        pixel = vsriq_n_u16(pixel, vshll_n_u8(bgrx.val[1], 8), 5);
+        pixel = vsriq_n_u16(pixel, vshll_n_u8(bgrx.val[0], 8), 11);
+        vst1q_u16(_dst, pixel);
+    }
+#endif
+
+    for (unsigned i = 0; i < _count; i++) {
+        _dst[i] = ::RGB888ToRGB565(_src[i]);
+    }
+}
+
+void PixelConvert::RGB888ToRGB666(u8 *_dst, const u32 *_src, unsigned _count)
+{
+    assert(_dst != 0 && _src != 0);
+
+#ifdef PIXEL_CONVERT_NEON
+    for (; _count >= 8; _count -= 8, _src += 8, _dst += 24) {
+        uint8x8x4_t bgrx = vld4_u8((const u8 *)_src);
+        uint8x8x3_t rgb;
+        rgb.val[0] = vshr_n_u8(bgrx.val[2], 2);
+        rgb.val[1] = vshr_n_u8(bgrx.val[1], 2);
+        rgb.val[2] = vshr_n_u8(bgrx.val[0], 2);
+        vst3_u8(_dst, rgb);
+    }
+#endif
+
+    for (unsigned i = 0; i < _count; i++) {
+        u32 color = _src[i];
+        *_dst++ = (color >> 18) & 0x3F;
+        *_dst++ = (color >> 10) & 0x3F;
+        *_dst++ = (color >> 2) & 0x3F;
+    }
+}
+
+void PixelConvert::SwapRGB565(u16 *_dst, const u16 *_src, unsigned _count)
+{
+    assert(_dst != 0 && _src != 0);
+
+#ifdef PIXEL_CONVERT_NEON
+    for (; _count >= 8; _count -= 8, _src += 8, _dst += 8) {
+        uint8x16_t bytes = vld1q_u8((const u8 *)_src);
+        vst1q_u8((u8 *)_dst, vrev16q_u8(bytes));
+    }
+#endif
+
+    for (unsigned i = 0; i < _count; i++) {
+        u16 pixel = _src[i];
+        _dst[i] = (pixel >> 8) | (pixel << 8);
+    }
+}
+
+void PixelConvert::BlendRGB565(u16 *_dst, const u16 *_fg, const u16 *_bg,
+                               unsigned _alpha, unsigned _count)
+{
+    assert(_dst != 0 && _fg != 0 && _bg != 0);
+    assert(_alpha <= 32);
+
+#ifdef PIXEL_CONVERT_NEON
+    int16x8_t alpha = vdupq_n_s16(_alpha);
+    uint16x8_t mask6 = vdupq_n_u16(0x3F);
+    uint16x8_t mask5 = vdupq_n_u16(0x1F);
+    for (; _count >= 8; _count -= 8, _fg += 8, _bg += 8, _dst += 8) {
+        uint16x8_t fg = vld1q_u16(_fg);
+        uint16x8_t bg = vld1q_u16(_bg);
+
+        // each channel in its own lane, bg + (fg - bg) * alpha / 32
+        int16x8_t fr = vreinterpretq_s16_u16(vshrq_n_u16(fg, 11));
+        int16x8_t br = vreinterpretq_s16_u16(vshrq_n_u16(bg, 11));
+        int16x8_t fgr = vreinterpretq_s16_u16(vandq_u16(vshrq_n_u16(fg, 5), mask6));
+        int16x8_t bgr = vreinterpretq_s16_u16(vandq_u16(vshrq_n_u16(bg, 5), mask6));
+        int16x8_t fb = vreinterpretq_s16_u16(vandq_u16(fg, mask5));
+        int16x8_t bb = vreinterpretq_s16_u16(vandq_u16(bg, mask5));
+
+        int16x8_t r = vaddq_s16(br, vshrq_n_s16(vmulq_s16(vsubq_s16(fr, br), alpha), 5));
+        int16x8_t g = vaddq_s16(bgr, vshrq_n_s16(vmulq_s16(vsubq_s16(fgr, bgr), alpha), 5));
+        int16x8_t b = vaddq_s16(bb, vshrq_n_s16(vmulq_s16(vsubq_s16(fb, bb), alpha), 5));
+
+        uint16x8_t pixel = vshlq_n_u16(vreinterpretq_u16_s16(r), 11);
+        pixel = vorrq_u16(pixel, vshlq_n_u16(vreinterpretq_u16_s16(g), 5));
+        pixel = vorrq_u16(pixel, vreinterpretq_u16_s16(b));
+        vst1q_u16(_dst, pixel);
+    }
+#endif
+
+    for (unsigned i = 0; i < _count; i++) {
+        _dst[i] = Blend565(_fg[i], _bg[i], _alpha);
+    }
+}
+
+const char *PixelConvert::GetImplementation(void)
+{
+#ifdef PIXEL_CONVERT_NEON
+    return "NEON";
+#else
+    return "C";
+#endif
+}
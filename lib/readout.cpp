@@ -0,0 +1,156 @@
+//
+// readout.cpp
+//
+// Numeric readout widget that redraws only the changed character cells
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <excircles/readout.h>
+#include <assert.h>
+
+ReadoutWidget::ReadoutWidget(DisplayDevice *_display, unsigned _x, unsigned _y, unsigned _cells)
+    : display(_display),
+      x(_x),
+      y(_y),
+      cells(_cells),
+      fg(0xFFFF),
+      bg(0x0000),
+      bytesSent(0)
+{
+    assert(display != 0);
+    assert(cells > 0 && cells <= READOUT_MAX_CELLS);
+
+    cellBuffer = new u16[font.GetCharWidth() * font.GetCharHeight()];
+    assert(cellBuffer != 0);
+
+    Invalidate();
+}
+
+ReadoutWidget::~ReadoutWidget(void)
+{
+    delete [] cellBuffer;
+    cellBuffer = 0;
+    display = 0;
+}
+
+void ReadoutWidget::SetColor(u16 _fg, u16 _bg)
+{
+    fg = _fg;
+    bg = _bg;
+}
+
+void ReadoutWidget::SetText(const char *_text)
+{
+    assert(_text != 0);
+
+    unsigned length = 0;
+    while (_text[length] != '\0') {
+        length++;
+    }
+    // keep the least significant part if the text does not fit
+    if (length > cells) {
+        _text += length - cells;
+        length = cells;
+    }
+
+    unsigned pad = cells - length;
+    for (unsigned i = 0; i < cells; i++) {
+        char glyph = i < pad ? ' ' : _text[i - pad];
+        if (shownValid[i] && shownGlyph[i] == glyph
+            && shownFg[i] == fg && shownBg[i] == bg) {
+            continue;
+        }
+        DrawCell(i, glyph);
+    }
+}
+
+void ReadoutWidget::SetValue(int _value, unsigned _decimals)
+{
+    assert(_decimals <= READOUT_MAX_CELLS - 2);
+    if (_decimals > READOUT_MAX_CELLS - 2) {
+        _decimals = READOUT_MAX_CELLS - 2;
+    }
+
+    char text[READOUT_MAX_CELLS + 1];
+    unsigned pos = READOUT_MAX_CELLS;
+    text[pos] = '\0';
+
+    boolean negative = _value < 0;
+    unsigned value = negative ? -(unsigned)_value : (unsigned)_value;
+
+    // at least one digit in front of the decimal point
+    unsigned digits = 1;
+    for (unsigned rest = value / 10; rest > 0; rest /= 10) {
+        digits++;
+    }
+    if (digits < _decimals + 1) {
+        digits = _decimals + 1;
+    }
+    unsigned length = digits + (_decimals > 0 ? 1 : 0) + (negative ? 1 : 0);
+
+    // a truncated number would be a wrong number
+    if (length > cells) {
+        for (unsigned i = 0; i < cells; i++) {
+            text[i] = READOUT_OVERFLOW_GLYPH;
+        }
+        text[cells] = '\0';
+        SetText(text);
+        return;
+    }
+
+    // digits right to left, the length check above left room for all of it
+    for (unsigned i = 0; i < digits; i++) {
+        if (_decimals > 0 && i == _decimals) {
+            text[--pos] = '.';
+        }
+        text[--pos] = '0' + value % 10;
+        value /= 10;
+    }
+    if (negative) {
+        text[--pos] = '-';
+    }
+
+    SetText(&text[pos]);
+}
+
+void ReadoutWidget::Invalidate(void)
+{
+    for (unsigned i = 0; i < READOUT_MAX_CELLS; i++) {
+        shownValid[i] = FALSE;
+    }
+}
+
+void ReadoutWidget::DrawCell(unsigned _cell, char _glyph)
+{
+    unsigned w = font.GetCharWidth();
+    unsigned h = font.GetCharHeight();
+
+    u16 *pixel = cellBuffer;
+    for (unsigned j = 0; j < h; j++) {
+        for (unsigned i = 0; i < w; i++) {
+            *pixel++ = font.GetPixel(_glyph, i, j) ? fg : bg;
+        }
+    }
+
+    unsigned cellX = x + _cell * w;
+    display->SetXY(cellX, cellX + w-1, y, y + h-1);
+    display->WritePixels(cellBuffer, w * h);
+    bytesSent += w * h * sizeof(u16);
+
+    shownGlyph[_cell] = _glyph;
+    shownFg[_cell] = fg;
+    shownBg[_cell] = bg;
+    shownValid[_cell] = TRUE;
+}
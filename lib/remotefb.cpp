@@ -0,0 +1,345 @@
+//
+// remotefb.cpp
+//
+// Receiver for compressed rectangle updates sent by a host over a serial line
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <circle/logger.h>
+#include <circle/timer.h>
+#include <excircles/remotefb.h>
+#include <assert.h>
+
+static const char FromRemoteFB[] = "remotefb";
+
+#define REMOTE_FB_PACKET_SIZE       (REMOTE_FB_HEADER_SIZE + REMOTE_FB_MAX_PAYLOAD + 2)
+// bytes taken from the serial device at once
+#define REMOTE_FB_READ_SIZE         256
+#define REMOTE_FB_PIXEL_BUFFER_SIZE 256
+
+static inline u16 GetU16(const u8 *_data)
+{
+    return _data[0] | (_data[1] << 8);
+}
+
+static u16 CRC16(const u8 *_data, unsigned _length)
+{
+    u16 crc = 0;
+    for (unsigned i = 0; i < _length; i++) {
+        crc ^= _data[i] << 8;
+        for (unsigned bit = 0; bit < 8; bit++) {
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+RemoteFramebuffer::RemoteFramebuffer(CDevice *_serial, DisplayDevice *_display)
+    : serial(_serial),
+      display(_display),
+      packet(0),
+      received(0),
+      lastByte(0),
+      rectX(0),
+      rectY(0),
+      rectWidth(0),
+      rectPixels(0),
+      position(0),
+      windowLeft(0),
+      frames(0),
+      packets(0),
+      errors(0)
+{
+    assert(serial != 0);
+    assert(display != 0);
+}
+
+RemoteFramebuffer::~RemoteFramebuffer(void)
+{
+    delete [] packet;
+    packet = 0;
+    serial = 0;
+    display = 0;
+}
+
+boolean RemoteFramebuffer::Initialize(void)
+{
+    packet = new u8[REMOTE_FB_PACKET_SIZE];
+    if (packet == 0) {
+        CLogger::Get()->Write(FromRemoteFB, LogError, "Cannot allocate the packet buffer");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+void RemoteFramebuffer::Update(void)
+{
+    assert(packet != 0);
+
+    u8 buffer[REMOTE_FB_READ_SIZE];
+    int result = serial->Read(buffer, sizeof buffer);
+    unsigned now = CTimer::GetClockTicks();
+
+    if (result < 0) {
+        // overrun or framing error, whatever was in the making is garbage
+        errors++;
+        received = 0;
+        return;
+    }
+    if (result == 0) {
+        if (received > 0 && now - lastByte > REMOTE_FB_TIMEOUT) {
+            // the rest got lost, the host sends the packet again
+            errors++;
+            received = 0;
+        }
+        return;
+    }
+
+    lastByte = now;
+    for (int i = 0; i < result; i++) {
+        Receive(buffer[i]);
+    }
+}
+
+void RemoteFramebuffer::Receive(u8 _byte)
+{
+    // hunt for the start of a packet
+    if (received == 0 && _byte != 'R') {
+        return;
+    }
+    if (received == 1 && _byte != 'F') {
+        received = _byte == 'R' ? 1 : 0;
+        return;
+    }
+
+    packet[received++] = _byte;
+    if (received < REMOTE_FB_HEADER_SIZE) {
+        return;
+    }
+
+    unsigned length = GetU16(&packet[12]);
+    if (length > REMOTE_FB_MAX_PAYLOAD) {
+        errors++;
+        Reply(REMOTE_FB_NAK);
+        received = 0;
+        return;
+    }
+    if (received == REMOTE_FB_HEADER_SIZE + length + 2) {
+        Process();
+        received = 0;
+    }
+}
+
+void RemoteFramebuffer::Process(void)
+{
+    unsigned type = packet[2];
+    unsigned length = GetU16(&packet[12]);
+    const u8 *payload = &packet[REMOTE_FB_HEADER_SIZE];
+
+    if (CRC16(&packet[2], REMOTE_FB_HEADER_SIZE - 2 + length) != GetU16(&payload[length])) {
+        errors++;
+        Reply(REMOTE_FB_NAK);
+        return;
+    }
+
+    if (type == REMOTE_FB_INFO) {
+        u8 reply[9] = {
+            REMOTE_FB_REPLY, REMOTE_FB_REPLY_INFO, packet[3],
+            (u8)display->GetWidth(), (u8)(display->GetWidth() >> 8),
+            (u8)display->GetHeight(), (u8)(display->GetHeight() >> 8),
+            (u8)REMOTE_FB_MAX_PAYLOAD, (u8)(REMOTE_FB_MAX_PAYLOAD >> 8)
+        };
+        serial->Write(reply, sizeof reply);
+        return;
+    }
+    if (type == REMOTE_FB_FRAME) {
+        frames++;
+        Reply(REMOTE_FB_ACK);
+        return;
+    }
+
+    rectX = GetU16(&packet[4]);
+    rectY = GetU16(&packet[6]);
+    rectWidth = GetU16(&packet[8]);
+    unsigned height = GetU16(&packet[10]);
+    rectPixels = rectWidth * height;
+    position = 0;
+    windowLeft = 0;
+
+    boolean ok = rectPixels > 0
+                 && rectX + rectWidth <= display->GetWidth()
+                 && rectY + height <= display->GetHeight();
+    if (ok) {
+        switch (type) {
+        case REMOTE_FB_RAW:
+            ok = DecodeRaw(payload, length);
+            break;
+        case REMOTE_FB_RLE:
+            ok = DecodeRLE(payload, length);
+            break;
+        case REMOTE_FB_DELTA:
+            ok = DecodeDelta(payload, length);
+            break;
+        default:
+            ok = FALSE;
+            break;
+        }
+    }
+    // a short or overlong payload leaves part of the rectangle drawn; it is
+    // redrawn completely when the host sends the packet again
+    ok = ok && position == rectPixels;
+
+    if (! ok) {
+        errors++;
+        Reply(REMOTE_FB_NAK);
+        return;
+    }
+
+    packets++;
+    Reply(REMOTE_FB_ACK);
+}
+
+void RemoteFramebuffer::Reply(u8 _status)
+{
+    u8 reply[3] = { REMOTE_FB_REPLY, _status, received >= 4 ? packet[3] : (u8)0 };
+    serial->Write(reply, sizeof reply);
+}
+
+boolean RemoteFramebuffer::DecodeRaw(const u8 *_data, unsigned _length)
+{
+    if (_length != 2 * rectPixels) {
+        return FALSE;
+    }
+
+    return Emit(_data, 0, rectPixels);
+}
+
+boolean RemoteFramebuffer::DecodeRLE(const u8 *_data, unsigned _length)
+{
+    const u8 *end = _data + _length;
+
+    while (_data < end) {
+        u8 control = *_data++;
+        unsigned count = (control & 0x7F) + 1;
+        if (control & 0x80) {
+            if (end - _data < 2 || ! Emit(0, GetU16(_data), count)) {
+                return FALSE;
+            }
+            _data += 2;
+        } else {
+            if ((unsigned)(end - _data) < 2 * count || ! Emit(_data, 0, count)) {
+                return FALSE;
+            }
+            _data += 2 * count;
+        }
+    }
+
+    return TRUE;
+}
+
+boolean RemoteFramebuffer::DecodeDelta(const u8 *_data, unsigned _length)
+{
+    const u8 *end = _data + _length;
+
+    while (_data < end) {
+        u8 control = *_data++;
+        unsigned count = (control & 0x3F) + 1;
+        switch (control & 0xC0) {
+        case 0x00:
+            if ((unsigned)(end - _data) < 2 * count || ! Emit(_data, 0, count)) {
+                return FALSE;
+            }
+            _data += 2 * count;
+            break;
+        case 0x40:
+            if (end - _data < 2 || ! Emit(0, GetU16(_data), count)) {
+                return FALSE;
+            }
+            _data += 2;
+            break;
+        case 0x80:
+            if (! Skip(count)) {
+                return FALSE;
+            }
+            break;
+        default:
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+boolean RemoteFramebuffer::Emit(const u8 *_pixels, u16 _color, unsigned _count)
+{
+    if (_count > rectPixels - position) {
+        return FALSE;
+    }
+
+    while (_count > 0) {
+        if (windowLeft == 0) {
+            unsigned x = rectX + position % rectWidth;
+            unsigned y = rectY + position / rectWidth;
+            if (x == rectX) {
+                // the rest of the rectangle, the window wraps the rows
+                unsigned rows = (rectPixels - position) / rectWidth;
+                display->SetXY(x, x + rectWidth - 1, y, y + rows - 1);
+                windowLeft = rectPixels - position;
+            } else {
+                // after a skip only the rest of the row can be a window
+                display->SetXY(x, rectX + rectWidth - 1, y, y);
+                windowLeft = rectX + rectWidth - x;
+            }
+        }
+
+        unsigned n = _count < windowLeft ? _count : windowLeft;
+        if (_pixels != 0) {
+            u16 buffer[REMOTE_FB_PIXEL_BUFFER_SIZE];
+            for (unsigned done = 0; done < n; ) {
+                unsigned chunk = n - done;
+                if (chunk > REMOTE_FB_PIXEL_BUFFER_SIZE) {
+                    chunk = REMOTE_FB_PIXEL_BUFFER_SIZE;
+                }
+                for (unsigned i = 0; i < chunk; i++) {
+                    buffer[i] = GetU16(_pixels);
+                    _pixels += 2;
+                }
+                display->WritePixels(buffer, chunk);
+                done += chunk;
+            }
+        } else {
+            display->FillPixels(_color, n);
+        }
+
+        position += n;
+        windowLeft -= n;
+        _count -= n;
+    }
+
+    return TRUE;
+}
+
+boolean RemoteFramebuffer::Skip(unsigned _count)
+{
+    if (_count > rectPixels - position) {
+        return FALSE;
+    }
+
+    position += _count;
+    windowLeft = 0;
+
+    return TRUE;
+}
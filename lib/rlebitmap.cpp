@@ -0,0 +1,166 @@
+//
+// rlebitmap.cpp
+//
+// Run-length encoded RGB565 bitmaps streamed to a display
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <circle/logger.h>
+#include <excircles/rlebitmap.h>
+#include <assert.h>
+
+static const char FromRLEBitmap[] = "rlebitmap";
+
+#define RLE_PIXEL_BUFFER_SIZE       64
+
+// collects decoded pixels and hands them to the display in chunks
+struct RLEPixelSink
+{
+    DisplayDevice *display;
+    u16 buffer[RLE_PIXEL_BUFFER_SIZE];
+    unsigned count;
+
+    void Flush(void)
+    {
+        if (count > 0) {
+            display->WritePixels(buffer, count);
+            count = 0;
+        }
+    }
+
+    void Put(u16 _color)
+    {
+        buffer[count++] = _color;
+        if (count == RLE_PIXEL_BUFFER_SIZE) {
+            Flush();
+        }
+    }
+};
+
+static inline u16 GetU16(const u8 *_data)
+{
+    return _data[0] | (_data[1] << 8);
+}
+
+RLEBitmap::RLEBitmap(const u8 *_data, unsigned _size)
+    : data(_data),
+      size(_size),
+      valid(FALSE),
+      width(0),
+      height(0),
+      flags(0),
+      key(0)
+{
+    assert(data != 0);
+
+    if (size < RLE_HEADER_SIZE || data[0] != 'R' || data[1] != '5') {
+        CLogger::Get()->Write(FromRLEBitmap, LogError, "Invalid bitmap header");
+        return;
+    }
+
+    width = GetU16(&data[2]);
+    height = GetU16(&data[4]);
+    flags = data[6];
+    key = GetU16(&data[8]);
+    valid = width > 0 && height > 0;
+}
+
+RLEBitmap::~RLEBitmap(void)
+{
+    data = 0;
+}
+
+void RLEBitmap::Draw(DisplayDevice *_display, unsigned _x, unsigned _y) const
+{
+    assert(_display != 0);
+    if (! valid) {
+        return;
+    }
+    assert(_x + width <= _display->GetWidth());
+    assert(_y + height <= _display->GetHeight());
+
+    RLEPixelSink sink;
+    sink.display = _display;
+    sink.count = 0;
+
+    boolean transparent = IsTransparent();
+    // opaque bitmaps go out through one window, transparent ones open
+    // a new window for each opaque span of a row
+    if (! transparent) {
+        _display->SetXY(_x, _x + width-1, _y, _y + height-1);
+    }
+
+    const u8 *p = data + RLE_HEADER_SIZE;
+    const u8 *end = data + size;
+    for (unsigned row = 0; row < height; row++) {
+        unsigned column = 0;
+        boolean windowOpen = ! transparent;
+        while (column < width) {
+            if (p >= end) {
+                CLogger::Get()->Write(FromRLEBitmap, LogError, "Truncated bitmap data");
+                sink.Flush();
+                return;
+            }
+
+            unsigned control = *p++;
+            unsigned count = (control & 0x7F) + 1;
+            unsigned payload = (control & 0x80) ? 2 : 2*count;
+            if (column + count > width || p + payload > end) {
+                CLogger::Get()->Write(FromRLEBitmap, LogError, "Corrupt bitmap data");
+                sink.Flush();
+                return;
+            }
+
+            if (control & 0x80) {
+                u16 color = GetU16(p);
+                p += 2;
+
+                if (transparent && color == key) {
+                    sink.Flush();
+                    windowOpen = FALSE;
+                    column += count;
+                    continue;
+                }
+                if (! windowOpen) {
+                    _display->SetXY(_x + column, _x + width-1, _y + row, _y + row);
+                    windowOpen = TRUE;
+                }
+                if (count >= RLE_FILL_THRESHOLD) {
+                    sink.Flush();
+                    _display->FillPixels(color, count);
+                } else {
+                    for (unsigned i = 0; i < count; i++) {
+                        sink.Put(color);
+                    }
+                }
+            } else {
+                if (! windowOpen) {
+                    _display->SetXY(_x + column, _x + width-1, _y + row, _y + row);
+                    windowOpen = TRUE;
+                }
+                for (unsigned i = 0; i < count; i++) {
+                    sink.Put(GetU16(p));
+                    p += 2;
+                }
+            }
+            column += count;
+        }
+        // the next row starts a new window when transparency is used
+        if (transparent) {
+            sink.Flush();
+        }
+    }
+    sink.Flush();
+}
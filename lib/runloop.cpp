@@ -0,0 +1,248 @@
+//
+// runloop.cpp
+//
+// Tickless event loop for timers, GPIO interrupts and completions
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <circle/logger.h>
+#include <circle/synchronize.h>
+#include <excircles/runloop.h>
+#include <assert.h>
+
+static const char FromRunLoop[] = "runloop";
+
+// the user timer cannot be armed for less
+#define RUNLOOP_MIN_TIMEOUT         2
+
+RunLoop::RunLoop(CInterruptSystem *_interrupt)
+    : userTimer(_interrupt, WakeUp, this),
+      stopped(FALSE)
+{
+    for (unsigned i = 0; i < RUNLOOP_MAX_TIMERS; i++) {
+        timers[i].used = FALSE;
+    }
+    for (unsigned i = 0; i < RUNLOOP_MAX_EVENTS; i++) {
+        events[i].used = FALSE;
+        events[i].pending = FALSE;
+    }
+}
+
+RunLoop::~RunLoop(void)
+{
+    userTimer.Stop();
+}
+
+boolean RunLoop::Initialize(void)
+{
+    if (! userTimer.Initialize()) {
+        CLogger::Get()->Write(FromRunLoop, LogError, "Cannot initialize the user timer");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+RunLoopTimer *RunLoop::AddTimer(unsigned _period, RunLoopHandler *_handler, void *_param,
+                                boolean _periodic)
+{
+    assert(_handler != 0);
+    assert(_period > 0);
+
+    for (unsigned i = 0; i < RUNLOOP_MAX_TIMERS; i++) {
+        RunLoopTimer *timer = &timers[i];
+        if (timer->used) {
+            continue;
+        }
+        timer->deadline = CTimer::GetClockTicks() + _period;
+        timer->period = _periodic ? _period : 0;
+        timer->handler = _handler;
+        timer->param = _param;
+        timer->used = TRUE;
+        return timer;
+    }
+
+    CLogger::Get()->Write(FromRunLoop, LogError, "No room for another timer");
+    return 0;
+}
+
+void RunLoop::RemoveTimer(RunLoopTimer *_timer)
+{
+    assert(_timer != 0);
+    _timer->used = FALSE;
+}
+
+RunLoopEvent *RunLoop::AddEvent(RunLoopHandler *_handler, void *_param)
+{
+    assert(_handler != 0);
+
+    for (unsigned i = 0; i < RUNLOOP_MAX_EVENTS; i++) {
+        RunLoopEvent *event = &events[i];
+        if (event->used) {
+            continue;
+        }
+        event->pending = FALSE;
+        event->handler = _handler;
+        event->param = _param;
+        event->used = TRUE;
+        return event;
+    }
+
+    CLogger::Get()->Write(FromRunLoop, LogError, "No room for another event");
+    return 0;
+}
+
+void RunLoop::RemoveEvent(RunLoopEvent *_event)
+{
+    assert(_event != 0);
+    _event->used = FALSE;
+}
+
+void RunLoop::Signal(RunLoopEvent *_event)
+{
+    assert(_event != 0);
+    _event->pending = TRUE;
+}
+
+void RunLoop::Completion(boolean _ok, void *_param)
+{
+    Signal((RunLoopEvent *)_param);
+}
+
+RunLoopEvent *RunLoop::AddGPIOSource(CGPIOPin *_pin, TGPIOInterrupt _trigger,
+                                     RunLoopHandler *_handler, void *_param)
+{
+    assert(_pin != 0);
+
+    RunLoopEvent *event = AddEvent(_handler, _param);
+    if (event == 0) {
+        return 0;
+    }
+    _pin->ConnectInterrupt(GPIOInterruptHandler, event);
+    _pin->EnableInterrupt(_trigger);
+
+    return event;
+}
+
+void RunLoop::GPIOInterruptHandler(void *_param)
+{
+    Signal((RunLoopEvent *)_param);
+}
+
+void RunLoop::WakeUp(CUserTimer *_userTimer, void *_param)
+{
+    // leaving WFI was all this was for
+}
+
+boolean RunLoop::Dispatch(void)
+{
+    boolean dispatched = FALSE;
+
+    for (unsigned i = 0; i < RUNLOOP_MAX_EVENTS; i++) {
+        RunLoopEvent *event = &events[i];
+        if (! event->used || ! event->pending) {
+            continue;
+        }
+        // a signal that comes in while the handler runs is not lost
+        event->pending = FALSE;
+        DataMemBarrier();
+        (*event->handler)(event->param);
+        dispatched = TRUE;
+    }
+
+    for (unsigned i = 0; i < RUNLOOP_MAX_TIMERS; i++) {
+        RunLoopTimer *timer = &timers[i];
+        unsigned now = CTimer::GetClockTicks();
+        if (! timer->used || (int)(now - timer->deadline) < 0) {
+            continue;
+        }
+
+        if (timer->period == 0) {
+            timer->used = FALSE;
+        } else {
+            timer->deadline += timer->period;
+            if ((int)(now - timer->deadline) >= 0) {
+                // too late for the lost periods, keep the phase
+                unsigned lost = (now - timer->deadline) / timer->period + 1;
+                timer->deadline += lost * timer->period;
+            }
+        }
+        (*timer->handler)(timer->param);
+        dispatched = TRUE;
+    }
+
+    return dispatched;
+}
+
+unsigned RunLoop::GetTimeout(void) const
+{
+    unsigned now = CTimer::GetClockTicks();
+    unsigned timeout = (unsigned)~0;
+
+    for (unsigned i = 0; i < RUNLOOP_MAX_TIMERS; i++) {
+        const RunLoopTimer *timer = &timers[i];
+        if (! timer->used) {
+            continue;
+        }
+        int left = (int)(timer->deadline - now);
+        if (left <= 0) {
+            return 0;
+        }
+        if ((unsigned)left < timeout) {
+            timeout = left;
+        }
+    }
+
+    return timeout;
+}
+
+void RunLoop::RunOnce(void)
+{
+    if (Dispatch()) {
+        return;
+    }
+
+    unsigned timeout = GetTimeout();
+    if (timeout == 0) {
+        return;
+    }
+    if (timeout != (unsigned)~0) {
+        userTimer.Start(timeout < RUNLOOP_MIN_TIMEOUT ? RUNLOOP_MIN_TIMEOUT : timeout);
+    }
+
+    // with interrupts masked an event cannot slip in between the check and
+    // WFI, which still wakes up on the pending interrupt
+    EnterCritical();
+    boolean pending = FALSE;
+    for (unsigned i = 0; i < RUNLOOP_MAX_EVENTS; i++) {
+        if (events[i].used && events[i].pending) {
+            pending = TRUE;
+        }
+    }
+    if (! pending) {
+        WaitForInterrupt();
+    }
+    LeaveCritical();
+
+    userTimer.Stop();
+}
+
+void RunLoop::Run(void)
+{
+    stopped = FALSE;
+    while (! stopped) {
+        RunOnce();
+    }
+}
@@ -0,0 +1,316 @@
+//
+// shadowfb.cpp
+//
+// RAM shadow framebuffer with dirty rectangle tracking
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <circle/logger.h>
+#include <excircles/shadowfb.h>
+#include <assert.h>
+
+static const char FromShadowFB[] = "shadowfb";
+
+// Four independent multiplicative lanes over pairs of pixels, so the loop
+// vectorizes; the lanes are folded together at the end.
+static u32 HashPixels(const u16 *_pixels, unsigned _count)
+{
+    u32 lane[4] = { 0x811C9DC5, 0x01000193, 0x27D4EB2F, 0x165667B1 };
+
+    unsigned i = 0;
+    for (; i + 8 <= _count; i += 8) {
+        for (unsigned k = 0; k < 4; k++) {
+            u32 word = _pixels[i + 2*k] | ((u32)_pixels[i + 2*k + 1] << 16);
+            lane[k] = (lane[k] ^ word) * 0x9E3779B1;
+        }
+    }
+    for (; i < _count; i++) {
+        lane[0] = (lane[0] ^ _pixels[i]) * 0x9E3779B1;
+    }
+
+    return lane[0] ^ (lane[1] << 7 | lane[1] >> 25)
+        ^ (lane[2] << 13 | lane[2] >> 19) ^ (lane[3] << 21 | lane[3] >> 11);
+}
+
+static inline unsigned Area(const DirtyRect &_rect)
+{
+    return (_rect.x1 - _rect.x0 + 1) * (_rect.y1 - _rect.y0 + 1);
+}
+
+static inline DirtyRect Union(const DirtyRect &_a, const DirtyRect &_b)
+{
+    DirtyRect rect;
+    rect.x0 = _a.x0 < _b.x0 ? _a.x0 : _b.x0;
+    rect.y0 = _a.y0 < _b.y0 ? _a.y0 : _b.y0;
+    rect.x1 = _a.x1 > _b.x1 ? _a.x1 : _b.x1;
+    rect.y1 = _a.y1 > _b.y1 ? _a.y1 : _b.y1;
+    return rect;
+}
+
+static inline boolean Contains(const DirtyRect &_outer, const DirtyRect &_inner)
+{
+    return _outer.x0 <= _inner.x0 && _outer.y0 <= _inner.y0
+        && _outer.x1 >= _inner.x1 && _outer.y1 >= _inner.y1;
+}
+
+ShadowFrameBuffer::ShadowFrameBuffer(DisplayDevice *_display)
+    : MemoryDisplayDevice(_display->GetWidth(), _display->GetHeight()),
+      display(_display),
+      dirtyCount(0),
+      windowCost(SHADOWFB_WINDOW_COST),
+      flushMode(ShadowFBFlushDirtyRects),
+      hashes(0),
+      hashSegments(0),
+      hashesValid(FALSE),
+      interlaced(FALSE),
+      interlaceMinPixels(SHADOWFB_INTERLACE_MIN_PIXELS),
+      field(0),
+      pendingCount(0),
+      flushedWindows(0),
+      flushedPixels(0)
+{
+    assert(display != 0);
+}
+
+ShadowFrameBuffer::~ShadowFrameBuffer(void)
+{
+    delete [] hashes;
+    hashes = 0;
+    display = 0;
+}
+
+void ShadowFrameBuffer::SetWindowCost(unsigned _pixels)
+{
+    windowCost = _pixels;
+}
+
+boolean ShadowFrameBuffer::SetFlushMode(ShadowFBFlushMode _mode)
+{
+    if (_mode == ShadowFBFlushHashDiff && hashes == 0) {
+        hashSegments = (width + SHADOWFB_HASH_SEGMENT-1) / SHADOWFB_HASH_SEGMENT;
+        hashes = new u32[hashSegments * height];
+        if (hashes == 0) {
+            CLogger::Get()->Write(FromShadowFB, LogError, "Cannot allocate row hashes");
+            return FALSE;
+        }
+    }
+
+    flushMode = _mode;
+    // the hashes do not know what was sent in the meantime
+    hashesValid = FALSE;
+
+    return TRUE;
+}
+
+void ShadowFrameBuffer::SetInterlaced(boolean _interlaced, unsigned _minPixels)
+{
+    interlaced = _interlaced;
+    interlaceMinPixels = _minPixels;
+}
+
+void ShadowFrameBuffer::AddDirty(unsigned _x0, unsigned _y0, unsigned _x1, unsigned _y1)
+{
+    DirtyRect rect = { _x0, _y0, _x1, _y1 };
+
+    // drop rectangles covered by the new one, skip the new one when covered
+    unsigned i = 0;
+    while (i < dirtyCount) {
+        if (Contains(dirtyRects[i], rect)) {
+            return;
+        }
+        if (Contains(rect, dirtyRects[i])) {
+            dirtyRects[i] = dirtyRects[--dirtyCount];
+            continue;
+        }
+        i++;
+    }
+
+    if (dirtyCount < SHADOWFB_MAX_DIRTY_RECTS) {
+        dirtyRects[dirtyCount++] = rect;
+        return;
+    }
+
+    // out of slots, grow the rectangle that gets the least bigger
+    unsigned best = 0;
+    unsigned bestGrowth = ~0U;
+    for (i = 0; i < dirtyCount; i++) {
+        unsigned growth = Area(Union(dirtyRects[i], rect)) - Area(dirtyRects[i]);
+        if (growth < bestGrowth) {
+            best = i;
+            bestGrowth = growth;
+        }
+    }
+    dirtyRects[best] = Union(dirtyRects[best], rect);
+}
+
+void ShadowFrameBuffer::MergeDirty(void)
+{
+    // merge two rectangles whenever their union costs no more than
+    // sending them separately, until no such pair is left
+    boolean merged = TRUE;
+    while (merged) {
+        merged = FALSE;
+        for (unsigned i = 0; i < dirtyCount && ! merged; i++) {
+            for (unsigned j = i + 1; j < dirtyCount; j++) {
+                DirtyRect rect = Union(dirtyRects[i], dirtyRects[j]);
+                if (Area(rect) + windowCost <= Area(dirtyRects[i]) + Area(dirtyRects[j]) + 2*windowCost) {
+                    dirtyRects[i] = rect;
+                    dirtyRects[j] = dirtyRects[--dirtyCount];
+                    merged = TRUE;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void ShadowFrameBuffer::DiffHashes(void)
+{
+    // rows with changed segments that overlap or touch horizontally are
+    // collected into one rectangle, MergeDirty() does the rest
+    DirtyRect rect = { 0, 0, 0, 0 };
+    boolean open = FALSE;
+
+    for (unsigned y = 0; y < height; y++) {
+        u32 *rowHashes = &hashes[y * hashSegments];
+        unsigned first = hashSegments;
+        unsigned last = 0;
+        for (unsigned i = 0; i < hashSegments; i++) {
+            unsigned x = i * SHADOWFB_HASH_SEGMENT;
+            unsigned count = width - x < SHADOWFB_HASH_SEGMENT ? width - x : SHADOWFB_HASH_SEGMENT;
+            u32 hash = HashPixels(&GetBuffer()[y * width + x], count);
+            if (! hashesValid || hash != rowHashes[i]) {
+                rowHashes[i] = hash;
+                if (first == hashSegments) {
+                    first = i;
+                }
+                last = i;
+            }
+        }
+
+        if (first == hashSegments) {
+            if (open) {
+                AddDirty(rect.x0, rect.y0, rect.x1, rect.y1);
+                open = FALSE;
+            }
+            continue;
+        }
+
+        unsigned x0 = first * SHADOWFB_HASH_SEGMENT;
+        unsigned x1 = (last + 1) * SHADOWFB_HASH_SEGMENT - 1;
+        if (x1 >= width) {
+            x1 = width - 1;
+        }
+        if (open && x0 <= rect.x1 + 1 && x1 + 1 >= rect.x0) {
+            rect.x0 = x0 < rect.x0 ? x0 : rect.x0;
+            rect.x1 = x1 > rect.x1 ? x1 : rect.x1;
+            rect.y1 = y;
+        } else {
+            if (open) {
+                AddDirty(rect.x0, rect.y0, rect.x1, rect.y1);
+            }
+            rect.x0 = x0;
+            rect.x1 = x1;
+            rect.y0 = y;
+            rect.y1 = y;
+            open = TRUE;
+        }
+    }
+    if (open) {
+        AddDirty(rect.x0, rect.y0, rect.x1, rect.y1);
+    }
+
+    hashesValid = TRUE;
+}
+
+void ShadowFrameBuffer::SendRect(const DirtyRect &_rect)
+{
+    const u16 *pixels = GetBuffer();
+    unsigned w = _rect.x1 - _rect.x0 + 1;
+    unsigned h = _rect.y1 - _rect.y0 + 1;
+
+    display->SetXY(_rect.x0, _rect.x1, _rect.y0, _rect.y1);
+    if (w == width) {
+        // full rows are contiguous in memory
+        display->WritePixels(&pixels[_rect.y0 * width], w * h);
+    } else {
+        for (unsigned y = _rect.y0; y <= _rect.y1; y++) {
+            display->WritePixels(&pixels[y * width + _rect.x0], w);
+        }
+    }
+
+    flushedWindows++;
+    flushedPixels += w * h;
+}
+
+void ShadowFrameBuffer::SendField(const DirtyRect &_rect, unsigned _field)
+{
+    const u16 *pixels = GetBuffer();
+    unsigned w = _rect.x1 - _rect.x0 + 1;
+
+    for (unsigned y = _rect.y0 + ((_rect.y0 & 1) != _field); y <= _rect.y1; y += 2) {
+        display->SetXY(_rect.x0, _rect.x1, y, y);
+        display->WritePixels(&pixels[y * width + _rect.x0], w);
+        flushedWindows++;
+        flushedPixels += w;
+    }
+}
+
+void ShadowFrameBuffer::Flush(void)
+{
+    assert(buffer != 0);
+
+    flushedWindows = 0;
+    flushedPixels = 0;
+
+    if (flushMode == ShadowFBFlushHashDiff) {
+        // the content decides what is sent, not what was drawn
+        dirtyCount = 0;
+        DiffHashes();
+    }
+
+    MergeDirty();
+
+    // owed rows are the ones of the current field, unless a new change
+    // covers them anyway
+    for (unsigned i = 0; i < pendingCount; i++) {
+        boolean covered = FALSE;
+        for (unsigned j = 0; j < dirtyCount && ! covered; j++) {
+            covered = Contains(dirtyRects[j], pending[i]);
+        }
+        if (! covered) {
+            SendField(pending[i], field);
+        }
+    }
+    pendingCount = 0;
+
+    unsigned changed = 0;
+    for (unsigned i = 0; i < dirtyCount; i++) {
+        changed += Area(dirtyRects[i]);
+    }
+
+    if (! interlaced || changed < interlaceMinPixels) {
+        for (unsigned i = 0; i < dirtyCount; i++) {
+            SendRect(dirtyRects[i]);
+        }
+    } else {
+        for (unsigned i = 0; i < dirtyCount; i++) {
+            SendField(dirtyRects[i], field);
+            pending[pendingCount++] = dirtyRects[i];
+        }
+        field ^= 1;
+    }
+    dirtyCount = 0;
+}
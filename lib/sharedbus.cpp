@@ -0,0 +1,186 @@
+//
+// sharedbus.cpp
+//
+// Display on a SPI bus shared with a touch controller
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <circle/timer.h>
+#include <excircles/sharedbus.h>
+#include <assert.h>
+
+SharedBusDisplay *SharedBusDisplay::s_pThis = 0;
+
+SharedBusDisplay::SharedBusDisplay(DisplayDevice *_display, TSC2046Device *_touch, SPIBus _bus,
+                                   unsigned _displayClock, unsigned _touchClock,
+                                   unsigned _samplePeriod, unsigned _chunkPixels)
+    : DisplayDevice(_display->GetWidth(), _display->GetHeight()),
+      display(_display),
+      touch(_touch),
+      bus(_bus),
+      displayClock(_displayClock),
+      touchClock(_touchClock),
+      samplePeriod(_samplePeriod),
+      chunkPixels(_chunkPixels),
+      deadline(CTimer::GetClockTicks() + _samplePeriod),
+      maxLatency(0),
+      samples(0),
+      eventHandler(0),
+      eventCount(0),
+      lostEvents(0)
+{
+    assert(display != 0);
+    assert(touch != 0);
+    assert(bus.IsValid());
+    assert(displayClock > 0 && touchClock > 0);
+    assert(samplePeriod > 0);
+    assert(chunkPixels > 0);
+
+    assert(s_pThis == 0);
+    s_pThis = this;
+    touch->RegisterEventHandler(TouchEventHandler);
+}
+
+SharedBusDisplay::~SharedBusDisplay(void)
+{
+    s_pThis = 0;
+    display = 0;
+    touch = 0;
+    eventHandler = 0;
+}
+
+void SharedBusDisplay::RegisterEventHandler(TSC2046EventHandler *_eventHandler)
+{
+    assert(eventHandler == 0);
+    eventHandler = _eventHandler;
+    assert(eventHandler != 0);
+}
+
+void SharedBusDisplay::Update(void)
+{
+    Poll();
+
+    // taken off the queue before the call, the handler may draw and
+    // further events may come in meanwhile
+    while (eventCount > 0) {
+        Event event = events[0];
+        eventCount--;
+        for (unsigned i = 0; i < eventCount; i++) {
+            events[i] = events[i + 1];
+        }
+        if (eventHandler != 0) {
+            (*eventHandler)(event.event, event.id, event.posX, event.posY);
+        }
+    }
+}
+
+void SharedBusDisplay::Poll(void)
+{
+    if ((int)(CTimer::GetClockTicks() - deadline) >= 0) {
+        Sample();
+    }
+}
+
+void SharedBusDisplay::Sample(void)
+{
+    unsigned now = CTimer::GetClockTicks();
+    unsigned late = now - deadline;
+    if (late > maxLatency) {
+        maxLatency = late;
+    }
+    samples++;
+
+    bus.SetClock(touchClock);
+    touch->Update();
+    bus.SetClock(displayClock);
+
+    // keep the rate, but do not catch up on samples missed while idle
+    deadline += samplePeriod;
+    if ((int)(now - deadline) >= 0) {
+        deadline = now + samplePeriod;
+    }
+}
+
+void SharedBusDisplay::TouchEventHandler(TSC2046Event _event, unsigned _id,
+                                         unsigned _posX, unsigned _posY)
+{
+    SharedBusDisplay *pThis = s_pThis;
+    assert(pThis != 0);
+
+    if (_event == TSC2046EventFingerMove && pThis->eventCount > 0) {
+        Event *last = &pThis->events[pThis->eventCount - 1];
+        if (last->event == TSC2046EventFingerMove && last->id == _id) {
+            last->posX = _posX;
+            last->posY = _posY;
+            return;
+        }
+    }
+
+    if (pThis->eventCount == SHARED_BUS_MAX_EVENTS) {
+        pThis->lostEvents++;
+        return;
+    }
+    Event *event = &pThis->events[pThis->eventCount++];
+    event->event = _event;
+    event->id = _id;
+    event->posX = _posX;
+    event->posY = _posY;
+}
+
+void SharedBusDisplay::ResetStats(void)
+{
+    maxLatency = 0;
+    samples = 0;
+    lostEvents = 0;
+}
+
+void SharedBusDisplay::SetXY(unsigned _x0, unsigned _x1, unsigned _y0, unsigned _y1)
+{
+    Poll();
+    display->SetXY(_x0, _x1, _y0, _y1);
+}
+
+void SharedBusDisplay::WritePixels(const u16 *_pixels, unsigned _count)
+{
+    while (_count > 0) {
+        unsigned n = _count < chunkPixels ? _count : chunkPixels;
+        display->WritePixels(_pixels, n);
+        _pixels += n;
+        _count -= n;
+        Poll();
+    }
+}
+
+void SharedBusDisplay::FillPixels(u16 _color, unsigned _count)
+{
+    while (_count > 0) {
+        unsigned n = _count < chunkPixels ? _count : chunkPixels;
+        display->FillPixels(_color, n);
+        _count -= n;
+        Poll();
+    }
+}
+
+void SharedBusDisplay::WriteRaw(const u8 *_data, unsigned _length)
+{
+    unsigned chunk = chunkPixels * display->GetBytesPerPixel();
+    while (_length > 0) {
+        unsigned n = _length < chunk ? _length : chunk;
+        display->WriteRaw(_data, n);
+        _data += n;
+        _length -= n;
+        Poll();
+    }
+}
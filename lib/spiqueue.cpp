@@ -0,0 +1,307 @@
+//
+// spiqueue.cpp
+//
+// Queue of SPI transfers that run in the background
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <circle/logger.h>
+#include <excircles/spiqueue.h>
+#include <assert.h>
+
+static const char FromSPIQueue[] = "spiqueue";
+
+SPIQueue::SPIQueue(SPIBus _bus)
+    : bus(_bus),
+      SPIMasterDMA(0),
+      active(FALSE),
+      inCallback(FALSE),
+      offset(0),
+      chunk(0),
+      chunkBytes(0),
+      memory(0),
+      txBounce(0),
+      rxBounce(0)
+{
+}
+
+SPIQueue::SPIQueue(CSPIMasterDMA *_SPIMasterDMA)
+    : SPIMasterDMA(_SPIMasterDMA),
+      active(FALSE),
+      inCallback(FALSE),
+      offset(0),
+      chunk(0),
+      chunkBytes(0),
+      memory(0),
+      txBounce(0),
+      rxBounce(0)
+{
+    assert(_SPIMasterDMA != 0);
+}
+
+SPIQueue::~SPIQueue(void)
+{
+    delete [] memory;
+    memory = 0;
+    txBounce = 0;
+    rxBounce = 0;
+    SPIMasterDMA = 0;
+}
+
+boolean SPIQueue::Initialize(void)
+{
+    memory = new u8[2 * SPIQUEUE_CHUNK_SIZE + SPIQUEUE_ALIGN-1];
+    if (memory == 0) {
+        CLogger::Get()->Write(FromSPIQueue, LogError, "Cannot allocate the bounce buffers");
+        return FALSE;
+    }
+    txBounce = (u8 *)(((uintptr)memory + SPIQUEUE_ALIGN-1) & ~(uintptr)(SPIQUEUE_ALIGN-1));
+    rxBounce = txBounce + SPIQUEUE_CHUNK_SIZE;
+
+    if (SPIMasterDMA != 0) {
+        SPIMasterDMA->SetCompletionRoutine(DMACompletion, this);
+    }
+
+    return TRUE;
+}
+
+boolean SPIQueue::WriteInline(unsigned _cs, CGPIOPin *_dc, unsigned _dcLevel,
+                              const u8 *_data, unsigned _length, u8 *_rx,
+                              SPIQueueCallback *_callback, void *_param)
+{
+    assert(_data != 0);
+    assert(_length > 0 && _length <= SPIQUEUE_INLINE_SIZE);
+
+    SPIQueueTransfer transfer;
+    transfer.cs = _cs;
+    transfer.dc = _dc;
+    transfer.dcLevel = _dcLevel;
+    transfer.data = 0;
+    transfer.pixels = 0;
+    transfer.pack = 0;
+    transfer.bytesPerPixel = 0;
+    transfer.length = _length;
+    transfer.rx = _rx;
+    for (unsigned i = 0; i < _length; i++) {
+        transfer.inlineData[i] = _data[i];
+    }
+    transfer.callback = _callback;
+    transfer.param = _param;
+
+    return Submit(transfer);
+}
+
+boolean SPIQueue::WriteBuffer(unsigned _cs, CGPIOPin *_dc, unsigned _dcLevel,
+                              const u8 *_data, unsigned _length,
+                              SPIQueueCallback *_callback, void *_param)
+{
+    assert(_data != 0);
+    assert(_length > 0);
+
+    SPIQueueTransfer transfer;
+    transfer.cs = _cs;
+    transfer.dc = _dc;
+    transfer.dcLevel = _dcLevel;
+    transfer.data = _data;
+    transfer.pixels = 0;
+    transfer.pack = 0;
+    transfer.bytesPerPixel = 0;
+    transfer.length = _length;
+    transfer.rx = 0;
+    transfer.callback = _callback;
+    transfer.param = _param;
+
+    return Submit(transfer);
+}
+
+boolean SPIQueue::WritePixels(unsigned _cs, CGPIOPin *_dc, unsigned _dcLevel,
+                              const u16 *_pixels, unsigned _count,
+                              SPIQueuePackFunction *_pack, unsigned _bytesPerPixel,
+                              SPIQueueCallback *_callback, void *_param)
+{
+    assert(_pixels != 0);
+    assert(_count > 0);
+    assert(_pack != 0);
+    assert(_bytesPerPixel > 0 && _bytesPerPixel <= SPIQUEUE_CHUNK_SIZE);
+
+    SPIQueueTransfer transfer;
+    transfer.cs = _cs;
+    transfer.dc = _dc;
+    transfer.dcLevel = _dcLevel;
+    transfer.data = 0;
+    transfer.pixels = _pixels;
+    transfer.pack = _pack;
+    transfer.bytesPerPixel = _bytesPerPixel;
+    transfer.length = _count;
+    transfer.rx = 0;
+    transfer.callback = _callback;
+    transfer.param = _param;
+
+    return Submit(transfer);
+}
+
+boolean SPIQueue::Submit(const SPIQueueTransfer &_transfer)
+{
+    assert(txBounce != 0);
+    // a second producer would race with the task on the queue
+    assert(! inCallback);
+
+    if (! queue.Push(_transfer)) {
+        return FALSE;
+    }
+
+    if (SPIMasterDMA != 0) {
+        // the completion interrupt must not pick up the queue meanwhile
+        EnterCritical();
+        if (! active && Next()) {
+            Start();
+        }
+        LeaveCritical();
+    }
+
+    return TRUE;
+}
+
+boolean SPIQueue::Next(void)
+{
+    if (! queue.Pop(&current)) {
+        active = FALSE;
+        return FALSE;
+    }
+
+    offset = 0;
+    active = TRUE;
+
+    return TRUE;
+}
+
+const u8 *SPIQueue::Prepare(void)
+{
+    // only now, a polled queue may sit between two Poll() calls for a
+    // while and a device without a queue may drive the pin meanwhile
+    if (offset == 0 && current.dc != 0) {
+        current.dc->Write(current.dcLevel);
+    }
+
+    if (current.pixels != 0) {
+        unsigned n = current.length - offset;
+        if (n > SPIQUEUE_CHUNK_SIZE / current.bytesPerPixel) {
+            n = SPIQUEUE_CHUNK_SIZE / current.bytesPerPixel;
+        }
+        (*current.pack)(txBounce, current.pixels + offset, n);
+        chunk = n;
+        chunkBytes = n * current.bytesPerPixel;
+        return txBounce;
+    }
+
+    if (current.data == 0) {
+        for (unsigned i = 0; i < current.length; i++) {
+            txBounce[i] = current.inlineData[i];
+        }
+        chunk = current.length;
+        chunkBytes = chunk;
+        return txBounce;
+    }
+
+    unsigned n = current.length - offset;
+    if (n > SPIQUEUE_CHUNK_SIZE) {
+        n = SPIQUEUE_CHUNK_SIZE;
+    }
+    chunk = n;
+    chunkBytes = n;
+    return current.data + offset;
+}
+
+void SPIQueue::Complete(boolean _ok)
+{
+    if (_ok && current.rx != 0) {
+        for (unsigned i = 0; i < chunkBytes; i++) {
+            current.rx[i] = rxBounce[i];
+        }
+    }
+
+    offset += chunk;
+    if (_ok && offset < current.length) {
+        // more chunks of the same transfer
+        Start();
+        return;
+    }
+
+    SPIQueueCallback *callback = current.callback;
+    void *param = current.param;
+    // the next transfer starts before the callback so the bus stays busy
+    if (Next()) {
+        Start();
+    }
+    if (callback != 0) {
+        inCallback = TRUE;
+        (*callback)(_ok, param);
+        inCallback = FALSE;
+    }
+}
+
+void SPIQueue::Start(void)
+{
+    if (SPIMasterDMA != 0) {
+        const u8 *tx = Prepare();
+        // DMA receives into the bounce buffer even when nobody wants the data
+        SPIMasterDMA->StartWriteRead(current.cs, tx, rxBounce, chunkBytes);
+    }
+    // a polled bus sends the chunk on the next Poll()
+}
+
+void SPIQueue::Poll(void)
+{
+    if (SPIMasterDMA != 0) {
+        return;
+    }
+
+    if (! active && ! Next()) {
+        return;
+    }
+
+    const u8 *tx = Prepare();
+    int result;
+    if (current.rx != 0) {
+        result = bus.WriteRead(current.cs, tx, rxBounce, chunkBytes);
+    } else {
+        result = bus.Write(current.cs, tx, chunkBytes);
+    }
+    boolean ok = result == (int)chunkBytes;
+    if (! ok) {
+        CLogger::Get()->Write(FromSPIQueue, LogError, "SPI write error");
+    }
+
+    Complete(ok);
+}
+
+void SPIQueue::Sync(void)
+{
+    while (! IsIdle()) {
+        Poll();
+    }
+}
+
+void SPIQueue::DMACompletion(boolean _ok, void *_param)
+{
+    SPIQueue *pThis = (SPIQueue *)_param;
+    assert(pThis != 0);
+    assert(pThis->active);
+
+    if (! _ok) {
+        CLogger::Get()->Write(FromSPIQueue, LogError, "SPI DMA error");
+    }
+    pThis->Complete(_ok);
+}
@@ -29,11 +29,20 @@
 
 static const char FromKernel[] = "kernel";
 
+// touch screen polling rate, in microseconds
+#define TOUCH_UPDATE_PERIOD     (1000000 / 60)
+
 CKernel *CKernel::s_pThis = 0;
 
+static void UpdateTouchScreen(void *_param)
+{
+    ((FT6206Device *)_param)->Update();
+}
+
 CKernel::CKernel(void)
     : Timer(&Interrupt),
       Logger(Options.GetLogLevel(), &Timer),
+      Loop(&Interrupt),
       I2CMaster(I2C_MASTER_DEVICE, I2C_FAST_MODE, I2C_MASTER_CONFIG),
       FT6206(&I2CMaster)
 {
@@ -71,6 +80,10 @@ boolean CKernel::Initialize(void)
         bOK = Timer.Initialize();
     }
 
+    if (bOK) {
+        bOK = Loop.Initialize();
+    }
+
     if (bOK) {
         bOK = I2CMaster.Initialize();
     }
@@ -95,10 +108,8 @@ TShutdownMode CKernel::Run(void)
 
     Logger.Write(FromKernel, LogNotice, "Just use your touchscreen!");
 
-    while (1) {
-        pTouchScreen->Update();
-        Timer.MsDelay(1000/60);
-    }
+    Loop.AddTimer(TOUCH_UPDATE_PERIOD, UpdateTouchScreen, pTouchScreen);
+    Loop.Run();
 
     return ShutdownReboot;
 }
@@ -31,6 +31,7 @@
 #include <circle/types.h>
 #include <circle/i2cmaster.h>
 #include <excircles/ft6206.h>
+#include <excircles/runloop.h>
 
 enum TShutdownMode
 {
@@ -64,6 +65,7 @@ private:
     CInterruptSystem Interrupt;
     CTimer Timer;
     CLogger Logger;
+    RunLoop Loop;
     CI2CMaster I2CMaster;
     FT6206Device FT6206;
     static CKernel *s_pThis;
@@ -31,9 +31,43 @@ static const char FromKernel[] = "kernel";
 // 0 or 1, or 2 (for SPI1)
 #define SPI_CHIP_SELECT     0
 
+// readout frames per second and frames shown
+#define READOUT_FPS         10
+#define READOUT_FRAMES      100
+
+struct Readout
+{
+    ReadoutWidget *counter;
+    ReadoutWidget *temperature;
+    unsigned frame;
+    FramePacer *pacer;
+    RunLoop *loop;
+};
+
+static boolean RenderReadout(unsigned _frames, void *_param)
+{
+    Readout *readout = (Readout *)_param;
+    // dropped frames are skipped, the count keeps up with the time
+    readout->frame += _frames;
+    readout->counter->SetValue(readout->frame);
+    readout->temperature->SetValue(215 + (readout->frame % 7), 1);
+    return TRUE;
+}
+
+// runs once per frame period from the loop
+static void TickReadout(void *_param)
+{
+    Readout *readout = (Readout *)_param;
+    readout->pacer->Tick();
+    if (readout->frame >= READOUT_FRAMES) {
+        readout->loop->Stop();
+    }
+}
+
 CKernel::CKernel(void)
     : Timer(&Interrupt),
       Logger(Options.GetLogLevel(), &Timer),
+      Loop(&Interrupt),
 #ifndef USE_SPI_MASTER_AUX
       SPIMaster(SPI_CLOCK_SPEED, SPI_CPOL, SPI_CPHA, SPI_MASTER_DEVICE),
 #else
@@ -69,6 +103,10 @@ boolean CKernel::Initialize(void)
         bOK = Timer.Initialize();
     }
 
+    if (bOK) {
+        bOK = Loop.Initialize();
+    }
+
     if (bOK) {
         bOK = SPIMaster.Initialize();
     }
@@ -132,6 +170,25 @@ TShutdownMode CKernel::Run(void)
     CTimer::SimpleMsDelay(1000);
     ILI9341.Square(x, y, size, 0x0000);
 
+    // only the digits that change are sent to the display
+    Logger.Write(FromKernel, LogNotice, "readout at 10 Hz");
+    ReadoutWidget counter(&ILI9341, 10, 100, 8);
+    ReadoutWidget temperature(&ILI9341, 10, 120, 8);
+    temperature.SetColor(0xF800, 0x0000);
+    FramePacer pacer(READOUT_FPS);
+    Readout readout = { &counter, &temperature, 0, &pacer, &Loop };
+    pacer.SetCallbacks(RenderReadout, 0, &readout);
+    RunLoopTimer *timer = Loop.AddTimer(1000000 / READOUT_FPS, TickReadout, &readout);
+    if (timer != 0) {
+        Loop.Run();
+        Loop.RemoveTimer(timer);
+    }
+    Logger.Write(FromKernel, LogNotice, "readout sent %u bytes",
+                 counter.GetBytesSent() + temperature.GetBytesSent());
+    Logger.Write(FromKernel, LogNotice, "readout %u frames, %u dropped, %u late, max %u us",
+                 pacer.GetDelivered(), pacer.GetDropped(), pacer.GetLate(),
+                 pacer.GetMaxFrameTime());
+
     Logger.Write(FromKernel, LogNotice, "\nRebooting..");
 
     return ShutdownReboot;
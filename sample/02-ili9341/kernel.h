@@ -38,7 +38,10 @@
 #else
 #include <circle/spimasteraux.h>
 #endif
+#include <excircles/framepacer.h>
 #include <excircles/ili9341.h>
+#include <excircles/readout.h>
+#include <excircles/runloop.h>
 
 enum TShutdownMode
 {
@@ -66,6 +69,7 @@ private:
     CInterruptSystem Interrupt;
     CTimer Timer;
     CLogger Logger;
+    RunLoop Loop;
 #ifndef USE_SPI_MASTER_AUX
     CSPIMaster SPIMaster;
 #else
@@ -32,11 +32,20 @@
 
 static const char FromKernel[] = "kernel";
 
+// touch screen polling rate, in microseconds
+#define TOUCH_UPDATE_PERIOD     (1000000 / 60)
+
 CKernel *CKernel::s_pThis = 0;
 
+static void UpdateTouchScreen(void *_param)
+{
+    ((TSC2046Device *)_param)->Update();
+}
+
 CKernel::CKernel(void)
     : Timer(&Interrupt),
       Logger(Options.GetLogLevel(), &Timer),
+      Loop(&Interrupt),
 #ifndef USE_SPI_MASTER_AUX
       SPIMaster(SPI_CLOCK_SPEED, SPI_CPOL, SPI_CPHA, SPI_MASTER_DEVICE),
 #else
@@ -78,6 +87,10 @@ boolean CKernel::Initialize(void)
         bOK = Timer.Initialize();
     }
 
+    if (bOK) {
+        bOK = Loop.Initialize();
+    }
+
     if (bOK) {
         bOK = SPIMaster.Initialize();
     }
@@ -104,10 +117,8 @@ TShutdownMode CKernel::Run(void)
 
     Logger.Write(FromKernel, LogNotice, "Just use your touchscreen!");
 
-    while (1) {
-        pTouchScreen->Update();
-        Timer.MsDelay(1000/60);
-    }
+    Loop.AddTimer(TOUCH_UPDATE_PERIOD, UpdateTouchScreen, pTouchScreen);
+    Loop.Run();
 
     return ShutdownReboot;
 }
@@ -35,6 +35,7 @@
 #include <circle/spimasteraux.h>
 #endif
 #include <excircles/tsc2046.h>
+#include <excircles/runloop.h>
 
 enum TShutdownMode
 {
@@ -68,6 +69,7 @@ private:
     CInterruptSystem Interrupt;
     CTimer Timer;
     CLogger Logger;
+    RunLoop Loop;
 #ifndef USE_SPI_MASTER_AUX
     CSPIMaster SPIMaster;
 #else
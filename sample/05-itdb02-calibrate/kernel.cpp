@@ -20,6 +20,9 @@
 
 static const char FromKernel[] = "kernel";
 
+// touch screen polling rate, in microseconds
+#define TOUCH_UPDATE_PERIOD     (1000000 / 60)
+
 // define 8 bit data bus lines
 #define LCD_PIN_DB0         21
 #define LCD_PIN_DB1         20
@@ -48,9 +51,15 @@ static const char FromKernel[] = "kernel";
 
 CKernel *CKernel::s_pThis = 0;
 
+static void UpdateTouchScreen(void *_param)
+{
+    ((TSC2046Device *)_param)->Update();
+}
+
 CKernel::CKernel(void)
     : Timer(&Interrupt),
       Logger(Options.GetLogLevel(), &Timer),
+      Loop(&Interrupt),
 #ifndef USE_SPI_MASTER_AUX
       SPIMaster(SPI_CLOCK_SPEED, SPI_CPOL, SPI_CPHA, SPI_MASTER_DEVICE),
 #else
@@ -97,6 +106,10 @@ boolean CKernel::Initialize(void)
         bOK = Timer.Initialize();
     }
 
+    if (bOK) {
+        bOK = Loop.Initialize();
+    }
+
     if (bOK) {
         bOK = SPIMaster.Initialize();
     }
@@ -128,6 +141,8 @@ TShutdownMode CKernel::Run(void)
 
     ILI9325D.Clear();
 
+    Loop.AddTimer(TOUCH_UPDATE_PERIOD, UpdateTouchScreen, &TSC2046);
+
     // 5 points
     GetSample(20, 20, 0);
     Timer.SimpleMsDelay(1000);
@@ -191,12 +206,8 @@ void CKernel::GetSample(int x, int y, int i)
     sampleY = 0;
     DrawCrossHair(x, y, 0x0FF0);
 
-    while (1) {
-        TSC2046.Update();
-        Timer.MsDelay(1000/60);
-        if (sampleX && sampleY && haveSample) {
-            break;
-        }
+    while (! (sampleX && sampleY && haveSample)) {
+        Loop.RunOnce();
     }
 
     haveSample = FALSE;
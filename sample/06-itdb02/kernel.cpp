@@ -20,6 +20,9 @@
 
 static const char FromKernel[] = "kernel";
 
+// touch screen polling rate, in microseconds
+#define TOUCH_UPDATE_PERIOD     (1000000 / 60)
+
 // define 8 bit data bus lines
 #define LCD_PIN_DB0         21
 #define LCD_PIN_DB1         20
@@ -48,9 +51,15 @@ static const char FromKernel[] = "kernel";
 
 CKernel *CKernel::s_pThis = 0;
 
+static void UpdateTouchScreen(void *_param)
+{
+    ((TSC2046Device *)_param)->Update();
+}
+
 CKernel::CKernel(void)
     : Timer(&Interrupt),
       Logger(Options.GetLogLevel(), &Timer),
+      Loop(&Interrupt),
 #ifndef USE_SPI_MASTER_AUX
       SPIMaster(SPI_CLOCK_SPEED, SPI_CPOL, SPI_CPHA, SPI_MASTER_DEVICE),
 #else
@@ -97,6 +106,10 @@ boolean CKernel::Initialize(void)
         bOK = Timer.Initialize();
     }
 
+    if (bOK) {
+        bOK = Loop.Initialize();
+    }
+
     if (bOK) {
         bOK = SPIMaster.Initialize();
     }
@@ -137,10 +150,8 @@ TShutdownMode CKernel::Run(void)
 
     Logger.Write(FromKernel, LogNotice, "Just use your touchscreen!");
 
-    while (1) {
-        TSC2046.Update();
-        Timer.MsDelay(1000/60);
-    }
+    Loop.AddTimer(TOUCH_UPDATE_PERIOD, UpdateTouchScreen, &TSC2046);
+    Loop.Run();
 
     Logger.Write(FromKernel, LogNotice, "\nRebooting..");
     return ShutdownReboot;
@@ -36,6 +36,7 @@
 #include <circle/spimasteraux.h>
 #endif
 #include <excircles/tsc2046.h>
+#include <excircles/runloop.h>
 #include <excircles/ili9325d.h>
 #include <excircles/tscalibration.h>
 
@@ -74,6 +75,7 @@ private:
     CInterruptSystem Interrupt;
     CTimer Timer;
     CLogger Logger;
+    RunLoop Loop;
 #ifndef USE_SPI_MASTER_AUX
     CSPIMaster SPIMaster;
 #else
@@ -20,6 +20,9 @@
 
 static const char FromKernel[] = "kernel";
 
+// touch screen polling rate, in microseconds
+#define TOUCH_UPDATE_PERIOD     (1000000 / 60)
+
 // 0, 4, 5, 6 on Raspberry Pi 4; 0 otherwise
 #define SPI_MASTER_DEVICE       0
 // 5 MHz
@@ -40,9 +43,15 @@ static const char FromKernel[] = "kernel";
 
 CKernel *CKernel::s_pThis = 0;
 
+static void UpdateTouchScreen(void *_param)
+{
+    ((FT6206Device *)_param)->Update();
+}
+
 CKernel::CKernel(void)
     : Timer(&Interrupt),
       Logger(Options.GetLogLevel(), &Timer),
+      Loop(&Interrupt),
 #ifndef USE_SPI_MASTER_AUX
       SPIMaster(SPI_CLOCK_SPEED, SPI_CPOL, SPI_CPHA, SPI_MASTER_DEVICE),
 #else
@@ -88,6 +97,10 @@ boolean CKernel::Initialize(void)
         bOK = Timer.Initialize();
     }
 
+    if (bOK) {
+        bOK = Loop.Initialize();
+    }
+
     if (bOK) {
         bOK = SPIMaster.Initialize();
     }
@@ -123,6 +136,8 @@ TShutdownMode CKernel::Run(void)
 
     ILI9341.Clear();
 
+    Loop.AddTimer(TOUCH_UPDATE_PERIOD, UpdateTouchScreen, &FT6206);
+
     // 5 points
     GetSample(20, 20, 0);
     Timer.SimpleMsDelay(1000);
@@ -186,12 +201,8 @@ void CKernel::GetSample(int _x, int _y, int _i)
     sampleY = 0;
     DrawCrossHair(_x, _y, 0x0FF0);
 
-    while (1) {
-        FT6206.Update();
-        Timer.MsDelay(1000/60);
-        if (sampleX && sampleY && haveSample) {
-            break;
-        }
+    while (! (sampleX && sampleY && haveSample)) {
+        Loop.RunOnce();
     }
 
     haveSample = FALSE;
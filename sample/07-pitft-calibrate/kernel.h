@@ -36,6 +36,7 @@
 #include <circle/spimasteraux.h>
 #endif
 #include <excircles/ft6206.h>
+#include <excircles/runloop.h>
 #include <excircles/ili9341.h>
 #include <excircles/tscalibration.h>
 
@@ -76,6 +77,7 @@ private:
     CInterruptSystem Interrupt;
     CTimer Timer;
     CLogger Logger;
+    RunLoop Loop;
 #ifndef USE_SPI_MASTER_AUX
     CSPIMaster SPIMaster;
 #else
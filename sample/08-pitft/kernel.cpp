@@ -20,6 +20,9 @@
 
 static const char FromKernel[] = "kernel";
 
+// touch screen polling rate, in microseconds
+#define TOUCH_UPDATE_PERIOD     (1000000 / 60)
+
 // 0, 4, 5, 6 on Raspberry Pi 4; 0 otherwise
 #define SPI_MASTER_DEVICE       0
 // 5 MHz
@@ -40,9 +43,15 @@ static const char FromKernel[] = "kernel";
 
 CKernel *CKernel::s_pThis = 0;
 
+static void UpdateTouchScreen(void *_param)
+{
+    ((FT6206Device *)_param)->Update();
+}
+
 CKernel::CKernel(void)
     : Timer(&Interrupt),
       Logger(Options.GetLogLevel(), &Timer),
+      Loop(&Interrupt),
 #ifndef USE_SPI_MASTER_AUX
       SPIMaster(SPI_CLOCK_SPEED, SPI_CPOL, SPI_CPHA, SPI_MASTER_DEVICE),
 #else
@@ -51,6 +60,7 @@ CKernel::CKernel(void)
       I2CMaster(I2C_MASTER_DEVICE, I2C_FAST_MODE, I2C_MASTER_CONFIG),
       FT6206(&I2CMaster),
       ILI9341(&SPIMaster, ILI9341_CHIP_SELECT, 25),
+      LineAA(&ILI9341),
       Calibration(240, 320, TsLibRotation180, FALSE)
 {
     s_pThis = this;
@@ -88,6 +98,10 @@ boolean CKernel::Initialize(void)
         bOK = Timer.Initialize();
     }
 
+    if (bOK) {
+        bOK = Loop.Initialize();
+    }
+
     if (bOK) {
         bOK = SPIMaster.Initialize();
     }
@@ -132,10 +146,8 @@ TShutdownMode CKernel::Run(void)
 
     Logger.Write(FromKernel, LogNotice, "Just use your touchscreen!");
 
-    while (1) {
-        FT6206.Update();
-        Timer.MsDelay(1000/60);
-    }
+    Loop.AddTimer(TOUCH_UPDATE_PERIOD, UpdateTouchScreen, &FT6206);
+    Loop.Run();
 
     Logger.Write(FromKernel, LogNotice, "\nRebooting..");
     return ShutdownReboot;
@@ -192,30 +204,7 @@ void CKernel::DrawPixel(int _x, int _y, int _color)
 
 void CKernel::DrawLine(int _x1, int _y1, int _x2, int _y2, int _color)
 {
-    int deltaX = _x2-_x1 >= 0 ? _x2-_x1 : _x1-_x2;
-    int signX  = _x1 < _x2 ? 1 : -1;
-
-    int deltaY = -(_y2-_y1 >= 0 ? _y2-_y1 : _y1-_y2);
-    int signY  = _y1 < _y2 ? 1 : -1;
-
-    int error = deltaX + deltaY;
-
-    while (1) {
-        DrawPixel((unsigned)_x1, (unsigned)_y1, _color);
-
-        if (_x1 == _x2 && _y1 == _y2) {
-            break;
-        }
-
-        int error2 = error + error;
-        if (error2 > deltaY) {
-            error += deltaY;
-            _x1 += signX;
-        }
-
-        if (error2 < deltaX) {
-            error += deltaX;
-            _y1 += signY;
-        }
-    }
+    // the screen is cleared to black before drawing starts
+    LineAA.SetColor(_color, 0x0000);
+    LineAA.DrawLine(_x1, _y1, _x2, _y2);
 }
@@ -36,7 +36,9 @@
 #include <circle/spimasteraux.h>
 #endif
 #include <excircles/ft6206.h>
+#include <excircles/runloop.h>
 #include <excircles/ili9341.h>
+#include <excircles/antialias.h>
 #include <excircles/tscalibration.h>
 
 enum TShutdownMode
@@ -74,6 +76,7 @@ private:
     CInterruptSystem Interrupt;
     CTimer Timer;
     CLogger Logger;
+    RunLoop Loop;
 #ifndef USE_SPI_MASTER_AUX
     CSPIMaster SPIMaster;
 #else
@@ -82,6 +85,7 @@ private:
     CI2CMaster I2CMaster;
     FT6206Device FT6206;
     ILI9341Device ILI9341;
+    AntiAlias LineAA;
     TsCalibration Calibration;
     unsigned posX;
 	unsigned posY;
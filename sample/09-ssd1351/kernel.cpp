@@ -151,6 +151,15 @@ TShutdownMode CKernel::Run(void)
     SSD1351.DrawLine(10, 100, 100, 10, 0xFFFF00);
     CTimer::SimpleMsDelay(1000);
 
+    // same lines anti-aliased, slightly shallower to show the smoothing
+    SSD1351.Clear();
+    AntiAlias aa(&SSD1351);
+    aa.SetColor(0xF81F, 0x0000);
+    aa.DrawLine(10, 20, 117, 100);
+    aa.SetColor(0xFFE0, 0x0000);
+    aa.DrawLine(10, 100, 117, 20);
+    CTimer::SimpleMsDelay(2000);
+
     SSD1351.Clear();
     SSD1351.Spectrum();
     CTimer::SimpleMsDelay(2000);
@@ -39,6 +39,7 @@
 #include <circle/spimasteraux.h>
 #endif
 #include <excircles/ssd1351.h>
+#include <excircles/antialias.h>
 
 enum TShutdownMode
 {
@@ -0,0 +1,165 @@
+//
+// kernel.cpp
+//
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include "kernel.h"
+#include <excircles/rgb565.h>
+
+static const char FromKernel[] = "kernel";
+
+// one ILI9341 frame worth of pixels
+#define PIXELS          (240 * 320)
+#define ROUNDS          10
+
+static u32 rgb888[PIXELS];
+static u16 foreground[PIXELS];
+static u16 background[PIXELS];
+static u16 rgb565[PIXELS];
+static u8 rgb666[3 * PIXELS];
+
+CKernel::CKernel(void)
+    : Timer(&Interrupt),
+      Logger(Options.GetLogLevel(), &Timer)
+{
+    // show we are alive
+    ActLED.Blink(5);
+}
+
+CKernel::~CKernel(void)
+{
+}
+
+boolean CKernel::Initialize(void)
+{
+    boolean bOK = TRUE;
+
+    if (bOK) {
+        bOK = Serial.Initialize(115200);
+    }
+
+    if (bOK) {
+        bOK = Logger.Initialize(&Serial);
+    }
+
+    if (bOK) {
+        bOK = Interrupt.Initialize();
+    }
+
+    if (bOK) {
+        bOK = Timer.Initialize();
+    }
+
+    return bOK;
+}
+
+TShutdownMode CKernel::Run(void)
+{
+    Logger.Write(FromKernel, LogNotice, "Compile time: " __DATE__ " " __TIME__);
+
+    Logger.Write(FromKernel, LogNotice, "Pixel conversion kernels (%s)",
+                 PixelConvert::GetImplementation());
+
+    // pseudo random test pattern
+    u32 seed = 12345;
+    for (unsigned i = 0; i < PIXELS; i++) {
+        seed = seed * 1103515245 + 12345;
+        rgb888[i] = seed >> 8;
+        foreground[i] = seed >> 16;
+        background[i] = seed;
+    }
+
+    if (! Verify()) {
+        Logger.Write(FromKernel, LogError, "Verification failed");
+    }
+
+    unsigned start = CTimer::GetClockTicks();
+    for (unsigned i = 0; i < ROUNDS; i++) {
+        PixelConvert::RGB888ToRGB565(rgb565, rgb888, PIXELS);
+    }
+    Report("RGB888 -> RGB565", CTimer::GetClockTicks() - start);
+
+    start = CTimer::GetClockTicks();
+    for (unsigned i = 0; i < ROUNDS; i++) {
+        PixelConvert::RGB888ToRGB666(rgb666, rgb888, PIXELS);
+    }
+    Report("RGB888 -> RGB666", CTimer::GetClockTicks() - start);
+
+    start = CTimer::GetClockTicks();
+    for (unsigned i = 0; i < ROUNDS; i++) {
+        PixelConvert::SwapRGB565(rgb565, rgb565, PIXELS);
+    }
+    Report("RGB565 swap", CTimer::GetClockTicks() - start);
+
+    start = CTimer::GetClockTicks();
+    for (unsigned i = 0; i < ROUNDS; i++) {
+        PixelConvert::BlendRGB565(rgb565, foreground, background, i * 3, PIXELS);
+    }
+    Report("RGB565 blend", CTimer::GetClockTicks() - start);
+
+    Logger.Write(FromKernel, LogNotice, "\nRebooting..");
+
+    return ShutdownReboot;
+}
+
+boolean CKernel::Verify(void)
+{
+    // compare against the single pixel helpers, odd count to cover the tail
+    unsigned count = 1027;
+
+    PixelConvert::RGB888ToRGB565(rgb565, rgb888, count);
+    for (unsigned i = 0; i < count; i++) {
+        if (rgb565[i] != RGB888ToRGB565(rgb888[i])) {
+            return FALSE;
+        }
+    }
+
+    PixelConvert::RGB888ToRGB666(rgb666, rgb888, count);
+    for (unsigned i = 0; i < count; i++) {
+        if (rgb666[3*i] != ((rgb888[i] >> 18) & 0x3F)
+            || rgb666[3*i + 1] != ((rgb888[i] >> 10) & 0x3F)
+            || rgb666[3*i + 2] != ((rgb888[i] >> 2) & 0x3F)) {
+            return FALSE;
+        }
+    }
+
+    PixelConvert::SwapRGB565(rgb565, foreground, count);
+    for (unsigned i = 0; i < count; i++) {
+        if (rgb565[i] != (u16)((foreground[i] >> 8) | (foreground[i] << 8))) {
+            return FALSE;
+        }
+    }
+
+    for (unsigned alpha = 0; alpha <= 32; alpha++) {
+        PixelConvert::BlendRGB565(rgb565, foreground, background, alpha, count);
+        for (unsigned i = 0; i < count; i++) {
+            if (rgb565[i] != Blend565(foreground[i], background[i], alpha)) {
+                return FALSE;
+            }
+        }
+    }
+
+    Logger.Write(FromKernel, LogNotice, "Verification passed");
+    return TRUE;
+}
+
+void CKernel::Report(const char *_name, unsigned _ticks)
+{
+    // ticks are microseconds
+    unsigned pixels = PIXELS * ROUNDS;
+    Logger.Write(FromKernel, LogNotice, "%-20s %7u us, %4u pixels/us",
+                 _name, _ticks, _ticks > 0 ? pixels / _ticks : 0);
+}
@@ -0,0 +1,114 @@
+//
+// kernel.cpp
+//
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include "kernel.h"
+#include <circle/debug.h>
+
+static const char FromKernel[] = "kernel";
+
+// 0, 4, 5, 6 on Raspberry Pi 4; 0 otherwise
+#define SPI_MASTER_DEVICE   0
+// 80 MHz
+#define SPI_CLOCK_SPEED     80000000
+#define SPI_CPOL            0
+#define SPI_CPHA            0
+
+// 0 or 1, or 2 (for SPI1)
+#define SPI_CHIP_SELECT     0
+
+// the host side is tools/remotefb.py, start it with the same baud rate
+#define SERIAL_BAUD         921600
+
+CKernel::CKernel(void)
+    : Serial(&Interrupt),
+      Timer(&Interrupt),
+      Logger(Options.GetLogLevel(), &Timer),
+#ifndef USE_SPI_MASTER_AUX
+      SPIMaster(SPI_CLOCK_SPEED, SPI_CPOL, SPI_CPHA, SPI_MASTER_DEVICE),
+#else
+      SPIMaster(SPI_CLOCK_SPEED),
+#endif
+      ILI9341(&SPIMaster, SPI_CHIP_SELECT, 25),
+      RemoteFB(&Serial, &ILI9341)
+{
+    // show we are alive
+    ActLED.Blink(5);
+}
+
+CKernel::~CKernel(void)
+{
+}
+
+boolean CKernel::Initialize(void)
+{
+    boolean bOK = TRUE;
+
+    // the serial device receives in interrupt mode, so the interrupt
+    // system goes first
+    if (bOK) {
+        bOK = Interrupt.Initialize();
+    }
+
+    if (bOK) {
+        bOK = Serial.Initialize(SERIAL_BAUD);
+    }
+
+    if (bOK) {
+        bOK = Logger.Initialize(&Serial);
+    }
+
+    if (bOK) {
+        bOK = Timer.Initialize();
+    }
+
+    if (bOK) {
+        bOK = SPIMaster.Initialize();
+    }
+
+    if (bOK) {
+        bOK = ILI9341.Initialize();
+    }
+
+    if (bOK) {
+        bOK = RemoteFB.Initialize();
+    }
+
+    return bOK;
+}
+
+TShutdownMode CKernel::Run(void)
+{
+    Logger.Write(FromKernel, LogNotice, "Compile time: " __DATE__ " " __TIME__);
+
+    Logger.Write(FromKernel, LogNotice, "waiting for frames at %u baud", SERIAL_BAUD);
+
+    ILI9341.Clear();
+
+    unsigned frames = 0;
+    while (1) {
+        RemoteFB.Update();
+
+        if (RemoteFB.GetFrames() != frames && RemoteFB.GetFrames() % 100 == 0) {
+            frames = RemoteFB.GetFrames();
+            Logger.Write(FromKernel, LogNotice, "%u frames, %u packets, %u errors",
+                         frames, RemoteFB.GetPackets(), RemoteFB.GetErrors());
+        }
+    }
+
+    return ShutdownHalt;
+}
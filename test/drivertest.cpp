@@ -0,0 +1,646 @@
+//
+// drivertest.cpp
+//
+// Runs the SPI display and touch drivers on a mock bus that decodes what
+// they send, directly, through an SPIQueue and behind a PanelGroup
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <excircles/ili9341.h>
+#include <excircles/memorydisplay.h>
+#include <excircles/panelgroup.h>
+#include <excircles/pixelformat.h>
+#include <excircles/runloop.h>
+#include <excircles/sharedbus.h>
+#include <excircles/ssd1351.h>
+#include <excircles/tsc2046.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DC_PIN          24
+#define DC2_PIN         25
+#define RESET_PIN       23
+#define MAX_PANELS      2
+// the clocks of sample/02-ili9341 and sample/03-tsc2046
+#define DISPLAY_CLOCK   80000000
+#define TOUCH_CLOCK     5000000
+
+static unsigned failures;
+
+static void Check(boolean _ok, const char *_what)
+{
+    if (! _ok && failures++ < 10) {
+        printf("FAIL %s\n", _what);
+    }
+}
+
+// What the controller makes of the bytes on the bus: commands with the
+// data/command pin low, their arguments and the pixels with it high. The
+// window and the wrapping follow the data sheets.
+class MockPanel
+{
+public:
+    MockPanel(unsigned _width, unsigned _height, unsigned _dcPin, boolean _ssd1351)
+        : width(_width),
+          height(_height),
+          dcPin(_dcPin),
+          ssd1351(_ssd1351),
+          command(0),
+          arguments(0),
+          bytes(0),
+          x0(0), x1(0), y0(0), y1(0), x(0), y(0)
+    {
+        frame = new u16[width * height];
+        memset(frame, 0, width * height * sizeof *frame);
+    }
+
+    ~MockPanel(void)
+    {
+        delete [] frame;
+    }
+
+    void Receive(const u8 *_data, unsigned _count)
+    {
+        boolean data = CGPIOPin::GetLevel(dcPin) == HIGH;
+        for (unsigned i = 0; i < _count; i++) {
+            if (data) {
+                Data(_data[i]);
+            } else {
+                command = _data[i];
+                arguments = 0;
+                bytes = 0;
+                if (command == (ssd1351 ? 0x5C : 0x2C)) {
+                    x = x0;
+                    y = y0;
+                }
+            }
+        }
+    }
+
+    u16 GetPixel(unsigned _x, unsigned _y) const { return frame[_y * width + _x]; }
+
+private:
+    void Data(u8 _byte)
+    {
+        if (ssd1351) {
+            // one byte per coordinate, RGB666 pixels
+            if (command == 0x15) {
+                *(arguments++ == 0 ? &x0 : &x1) = _byte;
+            } else if (command == 0x75) {
+                *(arguments++ == 0 ? &y0 : &y1) = _byte;
+            } else if (command == 0x5C) {
+                Pixel(_byte, 3);
+            }
+            return;
+        }
+
+        // two bytes per coordinate, high byte first, RGB565 pixels
+        if (command == 0x2A || command == 0x2B) {
+            args[arguments++ & 3] = _byte;
+            if (arguments == 4) {
+                *(command == 0x2A ? &x0 : &y0) = args[0] << 8 | args[1];
+                *(command == 0x2A ? &x1 : &y1) = args[2] << 8 | args[3];
+            }
+        } else if (command == 0x2C) {
+            Pixel(_byte, 2);
+        }
+    }
+
+    void Pixel(u8 _byte, unsigned _bytesPerPixel)
+    {
+        pixel[bytes++] = _byte;
+        if (bytes < _bytesPerPixel) {
+            return;
+        }
+        bytes = 0;
+
+        frame[y * width + x] = _bytesPerPixel == 3 ? PixelFormatRGB666::Load(pixel)
+                                                   : PixelFormatRGB565::Load(pixel);
+        if (++x > x1) {
+            x = x0;
+            y = y < y1 ? y + 1 : y0;
+        }
+    }
+
+private:
+    unsigned width;
+    unsigned height;
+    unsigned dcPin;
+    boolean ssd1351;
+    u16 *frame;
+
+    u8 command;
+    unsigned arguments;
+    u8 args[4];
+    u8 pixel[3];
+    unsigned bytes;
+    unsigned x0, x1, y0, y1, x, y;
+};
+
+// The bus the drivers are instantiated for: what is written goes to
+// _panel, reads return _reply, or zeros without one.
+class MockBus
+{
+public:
+    MockBus(MockPanel *_panel, const u8 *_reply = 0)
+        : panel(_panel),
+          reply(_reply)
+    {
+    }
+
+    void SetClock(unsigned _clockSpeed) {}
+
+    int Write(unsigned _cs, const void *_buffer, unsigned _count)
+    {
+        if (panel != 0) {
+            panel->Receive((const u8 *)_buffer, _count);
+        }
+        return _count;
+    }
+
+    int WriteRead(unsigned _cs, const void *_tx, void *_rx, unsigned _count)
+    {
+        if (reply != 0) {
+            memcpy(_rx, reply, _count);
+        } else {
+            memset(_rx, 0, _count);
+        }
+        return Write(_cs, _tx, _count);
+    }
+
+private:
+    MockPanel *panel;
+    const u8 *reply;
+};
+
+// The controller behind an SPIQueue or an SPIBus, panels are told apart
+// by chip select. It can also check the clock of each chip select, keep
+// the host clock moving at the pace of the bus and measure how many bytes
+// one chip select sends between two transfers of another.
+class MockSPIMaster : public CSPIMaster
+{
+public:
+    MockSPIMaster(void)
+        : wrongClocks(0),
+          timed(FALSE),
+          run(0),
+          longestRun(0),
+          clock(0)
+    {
+        memset(panels, 0, sizeof panels);
+        memset(replies, 0, sizeof replies);
+        memset(clocks, 0, sizeof clocks);
+    }
+
+    void SetClock(unsigned _clockSpeed) { clock = _clockSpeed; }
+
+    int Write(unsigned _chipSelect, const void *_buffer, unsigned _count)
+    {
+        assert(_chipSelect < MAX_PANELS && panels[_chipSelect] != 0);
+        panels[_chipSelect]->Receive((const u8 *)_buffer, _count);
+        Transfer(_chipSelect, _count);
+        run += _count;
+        if (run > longestRun) {
+            longestRun = run;
+        }
+        return _count;
+    }
+
+    int WriteRead(unsigned _chipSelect, const void *_tx, void *_rx, unsigned _count)
+    {
+        assert(_chipSelect < MAX_PANELS && replies[_chipSelect] != 0);
+        memcpy(_rx, replies[_chipSelect], _count);
+        Transfer(_chipSelect, _count);
+        run = 0;
+        return _count;
+    }
+
+    MockPanel *panels[MAX_PANELS];
+    // what a read returns, chip selects with a reply are read only
+    const u8 *replies[MAX_PANELS];
+    // the clock a chip select must be sent at, 0 for any
+    unsigned clocks[MAX_PANELS];
+    unsigned wrongClocks;
+    // moves the host clock by the time the bytes take on the bus
+    boolean timed;
+    // bytes written since the last read
+    unsigned run;
+    unsigned longestRun;
+
+private:
+    void Transfer(unsigned _chipSelect, unsigned _count)
+    {
+        if (clocks[_chipSelect] != 0 && clock != clocks[_chipSelect]) {
+            wrongClocks++;
+        }
+        if (timed) {
+            assert(clock != 0);
+            CTimer::AdvanceClockTicks((u64)_count * 8 * 1000000 / clock);
+        }
+    }
+
+private:
+    unsigned clock;
+};
+
+typedef ILI9341DeviceT<MockBus> MockILI9341Device;
+typedef SSD1351DeviceT<MockBus> MockSSD1351Device;
+typedef TSC2046DeviceT<MockBus> MockTSC2046Device;
+
+template class ILI9341DeviceT<MockBus>;
+template class SSD1351DeviceT<MockBus>;
+template class TSC2046DeviceT<MockBus>;
+
+static u16 Quantize(DisplayPixelFormat _format, u16 _color)
+{
+    u8 pixel[3];
+    if (_format == DisplayPixelFormatRGB666) {
+        PixelFormatRGB666::Store(pixel, _color);
+        return PixelFormatRGB666::Load(pixel);
+    }
+    return _color;
+}
+
+static boolean Same(const MockPanel *_panel, const MemoryDisplayDevice *_expected,
+                    DisplayPixelFormat _format, unsigned _offsetX = 0, unsigned _offsetY = 0,
+                    unsigned _width = 0, unsigned _height = 0)
+{
+    unsigned width = _width != 0 ? _width : _expected->GetWidth();
+    unsigned height = _height != 0 ? _height : _expected->GetHeight();
+    for (unsigned y = 0; y < height; y++) {
+        for (unsigned x = 0; x < width; x++) {
+            u16 expected = Quantize(_format, _expected->GetPixel(_offsetX + x, _offsetY + y));
+            if (_panel->GetPixel(x, y) != expected) {
+                printf("pixel %u, %u is %04X, not %04X\n", x, y, _panel->GetPixel(x, y), expected);
+                return FALSE;
+            }
+        }
+    }
+    return TRUE;
+}
+
+// random windows with pixel runs that wrap past their end, sent to the
+// driver and to the reference, blocking or through the driver's queue
+static void Scribble(QueuedDisplayDevice *_display, DisplayDevice *_reference, unsigned _seed)
+{
+    static u16 pixels[1000];
+    SPIQueue *queue = _display->GetQueue();
+
+    srand(_seed);
+    for (unsigned op = 0; op < 100; op++) {
+        unsigned x0 = rand() % _display->GetWidth();
+        unsigned x1 = x0 + rand() % (_display->GetWidth() - x0);
+        unsigned y0 = rand() % _display->GetHeight();
+        unsigned y1 = y0 + rand() % (_display->GetHeight() - y0);
+        unsigned count = 1 + rand() % 999;
+        for (unsigned i = 0; i < count; i++) {
+            pixels[i] = rand();
+        }
+
+        _reference->SetXY(x0, x1, y0, y1);
+        if (queue != 0) {
+            Check(_display->SetXYAsync(x0, x1, y0, y1), "SetXYAsync");
+        } else {
+            _display->SetXY(x0, x1, y0, y1);
+        }
+
+        if (queue != 0) {
+            _reference->WritePixels(pixels, count);
+            Check(_display->WritePixelsAsync(pixels, count), "WritePixelsAsync");
+            // the pixels belong to the queue until they are out
+            queue->Sync();
+        } else if (op & 1) {
+            _reference->WritePixels(pixels, count);
+            _display->WritePixels(pixels, count);
+        } else {
+            _reference->FillPixels(pixels[0], count);
+            _display->FillPixels(pixels[0], count);
+        }
+    }
+}
+
+template <class Device>
+static void TestDisplay(const char *_name, MockPanel *_panel, Device *_display,
+                        MockSPIMaster *_SPIMaster, unsigned _cs)
+{
+    MemoryDisplayDevice reference(_display->GetWidth(), _display->GetHeight());
+    DisplayPixelFormat format = _display->GetPixelFormat();
+    char what[80];
+
+    Check(_display->Initialize(), "display initialize");
+    Check(reference.Initialize(), "reference initialize");
+
+    Scribble(_display, &reference, 1);
+    snprintf(what, sizeof what, "%s blocking", _name);
+    Check(Same(_panel, &reference, format), what);
+
+    _display->FillRect(3, 5, 17, 9, 0xF81F);
+    reference.FillRect(3, 5, 17, 9, 0xF81F);
+    snprintf(what, sizeof what, "%s FillRect", _name);
+    Check(Same(_panel, &reference, format), what);
+
+    SPIBus bus(_SPIMaster);
+    SPIQueue queue(bus);
+    Check(queue.Initialize(), "queue initialize");
+    _SPIMaster->panels[_cs] = _panel;
+    _display->SetQueue(&queue);
+    Scribble(_display, &reference, 2);
+    _display->SetQueue(0);
+    snprintf(what, sizeof what, "%s queued", _name);
+    Check(Same(_panel, &reference, format), what);
+}
+
+static void TestPanelGroup(MockSPIMaster *_SPIMaster)
+{
+    // two ILI9341 side by side, one written directly, one through a queue
+    MockPanel left(ILI9341_WIDTH, ILI9341_HEIGHT, DC_PIN, FALSE);
+    MockPanel right(ILI9341_WIDTH, ILI9341_HEIGHT, DC2_PIN, FALSE);
+    MockILI9341Device leftDisplay(MockBus(&left), 0, DC_PIN);
+    MockILI9341Device rightDisplay(MockBus(&right), 1, DC2_PIN);
+    SPIBus bus(_SPIMaster);
+    SPIQueue queue(bus);
+    _SPIMaster->panels[1] = &right;
+    Check(queue.Initialize(), "queue initialize");
+    rightDisplay.SetQueue(&queue);
+
+    PanelGroup group(2 * ILI9341_WIDTH, ILI9341_HEIGHT);
+    Check(group.Initialize(), "group initialize");
+    Check(group.AddPanel(&leftDisplay, 0, 0), "add left panel");
+    Check(group.AddPanel(&rightDisplay, ILI9341_WIDTH, 0), "add right panel");
+    Check(! group.AddPanel(&leftDisplay, ILI9341_WIDTH + 1, 0), "panel off the canvas");
+
+    srand(3);
+    for (unsigned frame = 0; frame < 10; frame++) {
+        for (unsigned i = 0; i < 5; i++) {
+            unsigned x = rand() % group.GetWidth();
+            unsigned y = rand() % group.GetHeight();
+            group.FillRect(x, y, 1 + rand() % 200, 1 + rand() % 100, rand());
+        }
+        group.Flush();
+
+        Check(Same(&left, &group, DisplayPixelFormatRGB565, 0, 0,
+                   ILI9341_WIDTH, ILI9341_HEIGHT), "panel group left");
+        Check(Same(&right, &group, DisplayPixelFormatRGB565, ILI9341_WIDTH, 0,
+                   ILI9341_WIDTH, ILI9341_HEIGHT), "panel group right");
+    }
+}
+
+#ifdef SPIQUEUE_COROUTINES
+
+// just enough of a coroutine type to run one to its end
+struct TestTask
+{
+    struct promise_type
+    {
+        TestTask get_return_object(void) { return TestTask(); }
+        std::suspend_never initial_suspend(void) { return std::suspend_never(); }
+        std::suspend_never final_suspend(void) noexcept { return std::suspend_never(); }
+        void return_void(void) {}
+        void unhandled_exception(void) { abort(); }
+    };
+};
+
+static unsigned awaitedWrites;
+
+// one row after the other, the second write is queued by the coroutine
+// right after it was resumed for the first one
+static TestTask WriteRows(QueuedDisplayDevice *_display, RunLoop *_loop,
+                          const u16 *_pixels, unsigned _count, unsigned _rows)
+{
+    for (unsigned y = 0; y < _rows; y++) {
+        SPIQueueAwaiter awaiter(_loop);
+        Check(_display->SetXYAsync(0, _count - 1, y, y), "awaited SetXYAsync");
+        awaiter.SetQueued(_display->WritePixelsAsync(&_pixels[y * _count], _count,
+                                                     SPIQueueAwaiter::Completion, &awaiter));
+        boolean ok = co_await awaiter;
+        Check(ok, "awaited WritePixelsAsync");
+        awaitedWrites++;
+    }
+}
+
+static void TestAwaiter(MockSPIMaster *_SPIMaster)
+{
+    static u16 pixels[2 * 100];
+    MockPanel panel(ILI9341_WIDTH, ILI9341_HEIGHT, DC_PIN, FALSE);
+    MockILI9341Device display(MockBus(&panel), 0, DC_PIN);
+    MemoryDisplayDevice reference(ILI9341_WIDTH, ILI9341_HEIGHT);
+    CInterruptSystem interrupt;
+    RunLoop loop(&interrupt);
+    SPIBus bus(_SPIMaster);
+    SPIQueue queue(bus);
+    Check(display.Initialize(), "display initialize");
+    Check(reference.Initialize(), "reference initialize");
+    Check(loop.Initialize(), "loop initialize");
+    Check(queue.Initialize(), "queue initialize");
+    _SPIMaster->panels[0] = &panel;
+    display.SetQueue(&queue);
+
+    srand(4);
+    for (unsigned i = 0; i < 2 * 100; i++) {
+        pixels[i] = rand();
+    }
+    reference.SetXY(0, 99, 0, 1);
+    reference.WritePixels(pixels, 2 * 100);
+
+    WriteRows(&display, &loop, pixels, 100, 2);
+    Check(awaitedWrites == 0, "coroutine resumed before the loop ran");
+    for (unsigned i = 0; i < 100 && awaitedWrites < 2; i++) {
+        queue.Poll();
+        loop.RunOnce();
+    }
+    Check(awaitedWrites == 2, "two awaited writes");
+    Check(queue.IsIdle(), "queue idle after the awaited writes");
+    Check(Same(&panel, &reference, DisplayPixelFormatRGB565, 0, 0, 100, 2), "awaited rows");
+
+    display.SetQueue(0);
+}
+
+#endif // SPIQUEUE_COROUTINES
+
+static unsigned touchEvents[TSC2046EventUnknown + 1];
+static unsigned touchX;
+static unsigned touchY;
+
+static void TouchHandler(TSC2046Event _event, unsigned _id, unsigned _posX, unsigned _posY)
+{
+    touchEvents[_event]++;
+    touchX = _posX;
+    touchY = _posY;
+}
+
+// the last conversion of each channel is the one that counts
+static void SetSample(u8 *_reply, unsigned _z1, unsigned _z2, unsigned _x, unsigned _y)
+{
+    const unsigned values[4] = { _z1, _z2, _x, _y };
+    for (unsigned i = 0; i < 4; i++) {
+        _reply[9 * i + 7] = (values[i] << 3) >> 8;
+        _reply[9 * i + 8] = (values[i] << 3) & 0xFF;
+    }
+}
+
+static void TestTouch(void)
+{
+    u8 reply[TSC2046_SAMPLE_SIZE] = { 0 };
+    MockTSC2046Device touch(MockBus(0, reply), 0);
+    touch.RegisterEventHandler(TouchHandler);
+    Check(touch.Initialize(), "touch initialize");
+
+    // no pressure
+    SetSample(reply, 0, 4095, 0, 0);
+    touch.Update();
+    Check(touchEvents[TSC2046EventFingerDown] == 0, "touch without pressure");
+
+    SetSample(reply, 2000, 2000, 1234, 567);
+    touch.Update();
+    Check(touchEvents[TSC2046EventFingerDown] == 1 && touchX == 1234 && touchY == 567,
+          "finger down");
+    touch.Update();
+    Check(touchEvents[TSC2046EventFingerMove] == 0, "finger resting");
+
+    SetSample(reply, 2000, 2000, 1300, 600);
+    touch.Update();
+    Check(touchEvents[TSC2046EventFingerMove] == 1 && touchX == 1300 && touchY == 600,
+          "finger move");
+
+    SetSample(reply, 0, 4095, 0, 0);
+    touch.Update();
+    Check(touchEvents[TSC2046EventFingerUp] == 1, "finger up");
+}
+
+static SharedBusDisplay *sharedDisplay;
+static MemoryDisplayDevice *sharedReference;
+static boolean sharedWriting;
+static unsigned sharedEvents;
+static unsigned sharedEventsWhileWriting;
+
+// draws where the finger is, like a paint program would
+static void SharedTouchHandler(TSC2046Event _event, unsigned _id, unsigned _posX, unsigned _posY)
+{
+    if (sharedWriting) {
+        sharedEventsWhileWriting++;
+    }
+    sharedEvents++;
+
+    unsigned x = _posX % sharedDisplay->GetWidth();
+    unsigned y = _posY % sharedDisplay->GetHeight();
+    sharedDisplay->SetXY(x, x, y, y);
+    sharedDisplay->FillPixels(0xFFFF, 1);
+    sharedReference->SetXY(x, x, y, y);
+    sharedReference->FillPixels(0xFFFF, 1);
+}
+
+static void TestSharedBus(MockSPIMaster *_SPIMaster)
+{
+    static u16 pixels[ILI9341_WIDTH * ILI9341_HEIGHT];
+    const unsigned count = ILI9341_WIDTH * ILI9341_HEIGHT;
+    u8 reply[TSC2046_SAMPLE_SIZE] = { 0 };
+    MockPanel panel(ILI9341_WIDTH, ILI9341_HEIGHT, DC_PIN, FALSE);
+    MemoryDisplayDevice reference(ILI9341_WIDTH, ILI9341_HEIGHT);
+    SPIBus bus(_SPIMaster);
+    ILI9341Device display(bus, 0, DC_PIN);
+    TSC2046Device touch(bus, 1);
+    TSC2046Device touch2(bus, 1);
+    _SPIMaster->panels[0] = &panel;
+    _SPIMaster->panels[1] = 0;
+    _SPIMaster->replies[1] = reply;
+    _SPIMaster->SetClock(DISPLAY_CLOCK);
+    Check(display.Initialize(), "display initialize");
+    Check(touch.Initialize(), "touch initialize");
+    Check(reference.Initialize(), "reference initialize");
+
+    srand(5);
+    for (unsigned i = 0; i < count; i++) {
+        pixels[i] = rand();
+    }
+
+    CTimer::SetClockTicks(0);
+    _SPIMaster->timed = TRUE;
+    _SPIMaster->clocks[0] = DISPLAY_CLOCK;
+    _SPIMaster->clocks[1] = TOUCH_CLOCK;
+
+    {
+        // a sample is due after every chunk, so the chunks show between
+        // the reads
+        SharedBusDisplay shared(&display, &touch, bus, DISPLAY_CLOCK, TOUCH_CLOCK, 1, 1000);
+        shared.SetXY(0, ILI9341_WIDTH - 1, 0, ILI9341_HEIGHT - 1);
+        _SPIMaster->run = 0;
+        _SPIMaster->longestRun = 0;
+        shared.WritePixels(pixels, count);
+        Check(_SPIMaster->longestRun == 1000 * 2, "shared bus chunks");
+        Check(shared.GetSamples() == (count + 999) / 1000, "shared bus sample per chunk");
+    }
+
+    // a full screen takes 15 ms at 80 MHz, a sample every millisecond
+    // waits for one chunk at most
+    SharedBusDisplay shared(&display, &touch2, bus, DISPLAY_CLOCK, TOUCH_CLOCK, 1000);
+    sharedDisplay = &shared;
+    sharedReference = &reference;
+    shared.RegisterEventHandler(SharedTouchHandler);
+    SetSample(reply, 2000, 2000, 1234, 567);
+
+    reference.SetXY(0, ILI9341_WIDTH - 1, 0, ILI9341_HEIGHT - 1);
+    reference.WritePixels(pixels, count);
+    unsigned start = CTimer::GetClockTicks();
+    sharedWriting = TRUE;
+    shared.SetXY(0, ILI9341_WIDTH - 1, 0, ILI9341_HEIGHT - 1);
+    shared.WritePixels(pixels, count);
+    sharedWriting = FALSE;
+    unsigned elapsed = CTimer::GetClockTicks() - start;
+
+    unsigned chunkTime = SHARED_BUS_CHUNK_PIXELS * 2 * 8 / (DISPLAY_CLOCK / 1000000);
+    Check(shared.GetSamples() >= elapsed / 1000 - 1, "shared bus samples during the write");
+    Check(shared.GetMaxLatency() <= chunkTime, "shared bus latency");
+    Check(_SPIMaster->wrongClocks == 0, "shared bus clocks");
+    Check(sharedEventsWhileWriting == 0, "touch event during a write");
+    Check(sharedEvents == 0, "touch event before Update");
+
+    shared.Update();
+    Check(sharedEvents == 1, "touch event from Update");
+    Check(Same(&panel, &reference, DisplayPixelFormatRGB565), "shared bus frame");
+
+    CTimer::UseRealClock();
+    _SPIMaster->timed = FALSE;
+    memset(_SPIMaster->clocks, 0, sizeof _SPIMaster->clocks);
+    _SPIMaster->replies[1] = 0;
+}
+
+int main(void)
+{
+    MockSPIMaster SPIMaster;
+
+    MockPanel ili9341(ILI9341_WIDTH, ILI9341_HEIGHT, DC_PIN, FALSE);
+    MockILI9341Device ili9341Display(MockBus(&ili9341), 0, DC_PIN);
+    TestDisplay("ILI9341", &ili9341, &ili9341Display, &SPIMaster, 0);
+
+    MockPanel ssd1351(SSD1351_WIDTH, SSD1351_HEIGHT, DC_PIN, TRUE);
+    MockSSD1351Device ssd1351Display(MockBus(&ssd1351), 0, DC_PIN, RESET_PIN);
+    TestDisplay("SSD1351", &ssd1351, &ssd1351Display, &SPIMaster, 0);
+
+    TestPanelGroup(&SPIMaster);
+#ifdef SPIQUEUE_COROUTINES
+    TestAwaiter(&SPIMaster);
+#endif
+    TestTouch();
+    TestSharedBus(&SPIMaster);
+
+    if (failures > 0) {
+        printf("%u checks failed\n", failures);
+        return 1;
+    }
+    printf("all checks passed\n");
+
+    return 0;
+}
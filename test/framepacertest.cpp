@@ -0,0 +1,197 @@
+//
+// framepacertest.cpp
+//
+// Runs the frame pacer on a host clock that only moves when the test
+// moves it
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <circle/timer.h>
+#include <excircles/framepacer.h>
+#include <stdio.h>
+
+#define FPS             50
+#define PERIOD          (1000000 / FPS)
+
+static unsigned failures;
+
+static void Check(boolean _ok, const char *_what)
+{
+    if (! _ok && failures++ < 10) {
+        printf("FAIL %s\n", _what);
+    }
+}
+
+// what the render call was told and how it behaves
+struct Scene
+{
+    // sum of the frames passed to the render call
+    unsigned frames;
+    unsigned renders;
+    // clock at the start of the last render
+    unsigned last;
+    // microseconds the render and the flush take
+    unsigned renderTime;
+    unsigned flushTime;
+    boolean changing;
+};
+
+static boolean Render(unsigned _frames, void *_param)
+{
+    Scene *scene = (Scene *)_param;
+    scene->frames += _frames;
+    scene->renders++;
+    scene->last = CTimer::GetClockTicks();
+    CTimer::AdvanceClockTicks(scene->renderTime);
+    return scene->changing;
+}
+
+static void Flush(void *_param)
+{
+    Scene *scene = (Scene *)_param;
+    CTimer::AdvanceClockTicks(scene->flushTime);
+}
+
+// CTimer::GetClockTicks() at the next Tick()
+static unsigned nextTick;
+
+// _ticks calls once per frame period, like from a periodic RunLoop timer:
+// on time, or right away with the lost periods skipped when the callbacks
+// took longer
+static void Run(FramePacer *_pacer, unsigned _ticks)
+{
+    for (unsigned i = 0; i < _ticks; i++) {
+        unsigned now = CTimer::GetClockTicks();
+        if ((int)(now - nextTick) < 0) {
+            CTimer::SetClockTicks(nextTick);
+        }
+        _pacer->Tick();
+        nextTick += PERIOD;
+        now = CTimer::GetClockTicks();
+        if ((int)(now - nextTick) >= 0) {
+            nextTick += ((now - nextTick) / PERIOD + 1) * PERIOD;
+        }
+    }
+}
+
+// the frames passed to the render call add up to the time that passed
+// until the last one
+static boolean KeepsTime(const Scene *_scene, unsigned _start)
+{
+    unsigned elapsed = (_scene->last - _start) / PERIOD + 1;
+    if (_scene->frames != elapsed) {
+        printf("%u frames rendered in %u frame periods\n", _scene->frames, elapsed);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static void TestFullRate(void)
+{
+    Scene scene = { 0, 0, 0, 2000, 3000, TRUE };
+    FramePacer pacer(FPS);
+    pacer.SetCallbacks(Render, Flush, &scene);
+    unsigned start = CTimer::GetClockTicks();
+    nextTick = start;
+
+    Run(&pacer, FPS);
+    Check(scene.renders == FPS, "frames at the full rate");
+    Check(pacer.GetDelivered() == FPS, "frames delivered");
+    Check(pacer.GetDropped() == 0 && pacer.GetLate() == 0, "nothing dropped or late");
+    Check(pacer.GetRenderTime() == 2000 && pacer.GetFlushTime() == 3000, "render and flush time");
+    Check(pacer.GetMaxFrameTime() == 5000, "longest frame");
+    Check(KeepsTime(&scene, start), "full rate keeps time");
+}
+
+static void TestDropped(void)
+{
+    // two and a half frame periods per frame, every frame is late and
+    // overruns one or two deadlines
+    Scene scene = { 0, 0, 0, 5 * PERIOD / 2, 0, TRUE };
+    FramePacer pacer(FPS);
+    pacer.SetCallbacks(Render, Flush, &scene);
+    unsigned start = CTimer::GetClockTicks();
+    nextTick = start;
+
+    Run(&pacer, FPS);
+    Check(pacer.GetLate() == scene.renders, "every slow frame late");
+    Check(pacer.GetDropped() == scene.frames - scene.renders, "overrun deadlines dropped");
+    Check(pacer.GetDropped() > 0, "frames dropped");
+    Check(KeepsTime(&scene, start), "dropped frames keep time");
+
+    pacer.ResetStats();
+    Check(pacer.GetLate() == 0 && pacer.GetDropped() == 0, "stats reset");
+}
+
+static void TestIdle(void)
+{
+    Scene scene = { 0, 0, 0, 1000, 0, FALSE };
+    FramePacer pacer(FPS);
+    pacer.SetCallbacks(Render, Flush, &scene);
+    unsigned start = CTimer::GetClockTicks();
+    nextTick = start;
+
+    // unchanged frames at the full rate until the pacer gives up
+    Run(&pacer, FRAME_PACER_IDLE_FRAMES - 1);
+    Check(! pacer.IsIdle(), "idle too early");
+    Run(&pacer, 1);
+    Check(pacer.IsIdle(), "idle after unchanged frames");
+    Check(scene.renders == FRAME_PACER_IDLE_FRAMES, "frames before idle");
+
+    // two seconds at the idle rate, still counted in full rate frames
+    unsigned renders = scene.renders;
+    Run(&pacer, 2 * FPS);
+    Check(scene.renders - renders == 2 * FRAME_PACER_IDLE_FPS, "frames at the idle rate");
+    Check(KeepsTime(&scene, start), "idle keeps time");
+    Check(pacer.GetDropped() == 0, "idle frames counted as dropped");
+    Check(pacer.GetDelivered() == 0, "unchanged frames delivered");
+
+    // woken up in the middle of an idle period: the next Tick() renders
+    // and makes up for the idle time
+    Run(&pacer, 3);
+    pacer.Wake();
+    Check(! pacer.IsIdle(), "awake after Wake()");
+    scene.changing = TRUE;
+    renders = scene.renders;
+    Run(&pacer, 1);
+    Check(scene.renders == renders + 1, "frame right after Wake()");
+    Check(KeepsTime(&scene, start), "Wake() keeps time");
+    Check(pacer.GetDropped() == 0, "idle frames dropped after Wake()");
+
+    Run(&pacer, FPS);
+    Check(! pacer.IsIdle(), "idle while changing");
+    Check(KeepsTime(&scene, start), "full rate after idle keeps time");
+    Check(pacer.GetDropped() == 0, "frames dropped after idle");
+}
+
+int main(void)
+{
+    CTimer::SetClockTicks(0);
+    TestFullRate();
+    TestDropped();
+    TestIdle();
+
+    // the pacer works with the clock wrapping around
+    CTimer::SetClockTicks(-500000);
+    TestIdle();
+
+    if (failures > 0) {
+        printf("%u checks failed\n", failures);
+        return 1;
+    }
+    printf("all checks passed\n");
+
+    return 0;
+}
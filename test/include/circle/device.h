@@ -0,0 +1,35 @@
+//
+// device.h
+//
+// Host stand-in for the circle header of the same name
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _circle_device_h
+#define _circle_device_h
+
+#include <circle/types.h>
+
+class CDevice
+{
+public:
+    CDevice(void) {}
+    virtual ~CDevice(void) {}
+
+    virtual int Read(void *_buffer, size_t _count) { return -1; }
+    virtual int Write(const void *_buffer, size_t _count) { return -1; }
+};
+
+#endif // _circle_device_h
@@ -0,0 +1,39 @@
+//
+// devicenameservice.h
+//
+// Host stand-in for the circle header of the same name
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _circle_devicenameservice_h
+#define _circle_devicenameservice_h
+
+#include <circle/device.h>
+#include <circle/types.h>
+
+// names are accepted and forgotten
+class CDeviceNameService
+{
+public:
+    static CDeviceNameService *Get(void)
+    {
+        static CDeviceNameService service;
+        return &service;
+    }
+
+    void AddDevice(const char *_name, CDevice *_device, boolean _blockDevice) {}
+};
+
+#endif // _circle_devicenameservice_h
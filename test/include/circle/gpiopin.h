@@ -0,0 +1,86 @@
+//
+// gpiopin.h
+//
+// Host stand-in for the circle header of the same name
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _circle_gpiopin_h
+#define _circle_gpiopin_h
+
+#include <circle/types.h>
+
+#define LOW         0
+#define HIGH        1
+
+#define GPIO_PINS   54
+
+enum TGPIOMode
+{
+    GPIOModeInput,
+    GPIOModeOutput,
+    GPIOModeInputPullUp,
+    GPIOModeInputPullDown,
+    GPIOModeUnknown
+};
+
+enum TGPIOInterrupt
+{
+    GPIOInterruptOnRisingEdge,
+    GPIOInterruptOnFallingEdge,
+    GPIOInterruptOnBothEdges,
+    GPIOInterruptOnHighLevel,
+    GPIOInterruptOnLowLevel,
+    GPIOInterruptUnknown
+};
+
+typedef void TGPIOInterruptHandler(void *_param);
+
+class CGPIOManager;
+
+// Output levels are kept per pin number, so a test can see the level of
+// a pin that belongs to a driver, e.g. the data/command line of a display.
+class CGPIOPin
+{
+public:
+    CGPIOPin(unsigned _pin, TGPIOMode _mode, CGPIOManager *_manager = 0)
+        : pin(_pin)
+    {
+    }
+
+    void Write(unsigned _value) { GetLevels()[pin] = _value; }
+    unsigned Read(void) const { return GetLevels()[pin]; }
+
+    // no interrupts on the host
+    void ConnectInterrupt(TGPIOInterruptHandler *_handler, void *_param, boolean _autoAck = TRUE) {}
+    void DisconnectInterrupt(void) {}
+    void EnableInterrupt(TGPIOInterrupt _trigger) {}
+    void DisableInterrupt(void) {}
+
+    // host only
+    static unsigned GetLevel(unsigned _pin) { return GetLevels()[_pin]; }
+
+private:
+    static unsigned *GetLevels(void)
+    {
+        static unsigned levels[GPIO_PINS];
+        return levels;
+    }
+
+private:
+    unsigned pin;
+};
+
+#endif // _circle_gpiopin_h
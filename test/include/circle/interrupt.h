@@ -0,0 +1,33 @@
+//
+// interrupt.h
+//
+// Host stand-in for the circle header of the same name
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _circle_interrupt_h
+#define _circle_interrupt_h
+
+#include <circle/types.h>
+
+// only there to build against, nothing interrupts on the host
+class CInterruptSystem
+{
+public:
+    CInterruptSystem(void) {}
+    boolean Initialize(void) { return TRUE; }
+};
+
+#endif // _circle_interrupt_h
@@ -0,0 +1,61 @@
+//
+// logger.h
+//
+// Host stand-in for the circle header of the same name
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _circle_logger_h
+#define _circle_logger_h
+
+#include <circle/types.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+enum TLogSeverity
+{
+    LogPanic,
+    LogError,
+    LogWarning,
+    LogNotice,
+    LogDebug
+};
+
+// warnings and errors go to stderr, the rest is dropped
+class CLogger
+{
+public:
+    static CLogger *Get(void)
+    {
+        static CLogger logger;
+        return &logger;
+    }
+
+    void Write(const char *_source, TLogSeverity _severity, const char *_message, ...)
+        __attribute__((format(printf, 4, 5)))
+    {
+        if (_severity > LogWarning) {
+            return;
+        }
+        va_list args;
+        va_start(args, _message);
+        fprintf(stderr, "%s: ", _source);
+        vfprintf(stderr, _message, args);
+        fprintf(stderr, "\n");
+        va_end(args);
+    }
+};
+
+#endif // _circle_logger_h
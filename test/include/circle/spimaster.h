@@ -0,0 +1,54 @@
+//
+// spimaster.h
+//
+// Host stand-in for the circle header of the same name
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _circle_spimaster_h
+#define _circle_spimaster_h
+
+#include <circle/types.h>
+#include <string.h>
+
+// The transfers and the clock are virtual, so a test can derive a
+// controller that watches the bus; this one sends into the void and
+// receives zeros.
+class CSPIMaster
+{
+public:
+    CSPIMaster(unsigned _clockSpeed = 500000, unsigned _CPOL = 0, unsigned _CPHA = 0,
+               unsigned _device = 0)
+    {
+    }
+    virtual ~CSPIMaster(void) {}
+
+    boolean Initialize(void) { return TRUE; }
+    virtual void SetClock(unsigned _clockSpeed) {}
+
+    virtual int Write(unsigned _chipSelect, const void *_buffer, unsigned _count)
+    {
+        return _count;
+    }
+
+    virtual int WriteRead(unsigned _chipSelect, const void *_writeBuffer, void *_readBuffer,
+                          unsigned _count)
+    {
+        memset(_readBuffer, 0, _count);
+        return Write(_chipSelect, _writeBuffer, _count);
+    }
+};
+
+#endif // _circle_spimaster_h
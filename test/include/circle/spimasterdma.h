@@ -0,0 +1,50 @@
+//
+// spimasterdma.h
+//
+// Host stand-in for the circle header of the same name
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _circle_spimasterdma_h
+#define _circle_spimasterdma_h
+
+#include <circle/types.h>
+#include <assert.h>
+
+class CInterruptSystem;
+
+typedef void TSPICompletionRoutine(boolean _status, void *_param);
+
+// only there to build against, the host tests use polled queues
+class CSPIMasterDMA
+{
+public:
+    CSPIMasterDMA(CInterruptSystem *_interrupt, unsigned _clockSpeed = 500000,
+                  unsigned _CPOL = 0, unsigned _CPHA = 0, boolean _DMAChannelLite = TRUE)
+    {
+    }
+
+    boolean Initialize(void) { return TRUE; }
+    void SetClock(unsigned _clockSpeed) {}
+    void SetCompletionRoutine(TSPICompletionRoutine *_routine, void *_param) {}
+
+    void StartWriteRead(unsigned _chipSelect, const void *_writeBuffer, void *_readBuffer,
+                        unsigned _count)
+    {
+        assert(0);
+    }
+};
+
+#endif // _circle_spimasterdma_h
@@ -0,0 +1,41 @@
+//
+// synchronize.h
+//
+// Host stand-in for the circle header of the same name
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _circle_synchronize_h
+#define _circle_synchronize_h
+
+#include <circle/types.h>
+
+#define DATA_CACHE_LINE_LENGTH_MAX  64
+
+#define IRQ_LEVEL   1
+
+// a single thread, nothing to lock out
+static inline void EnterCritical(unsigned _targetLevel = IRQ_LEVEL) {}
+static inline void LeaveCritical(void) {}
+
+// nothing would wake the core up, so it does not sleep
+static inline void WaitForInterrupt(void) {}
+
+#define DataMemBarrier()    __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define DataSyncBarrier()   __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+static inline void CleanAndInvalidateDataCacheRange(uintptr _address, unsigned _length) {}
+
+#endif // _circle_synchronize_h
@@ -0,0 +1,73 @@
+//
+// timer.h
+//
+// Host stand-in for the circle header of the same name
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _circle_timer_h
+#define _circle_timer_h
+
+#include <circle/types.h>
+#include <time.h>
+
+// The clock runs in real time and the delays return at once, unless a
+// test sets the clock with SetClockTicks(). From then on it only moves
+// when the test or a delay moves it.
+class CTimer
+{
+public:
+    static unsigned GetClockTicks(void)
+    {
+        if (GetFake()->set) {
+            return GetFake()->ticks;
+        }
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return (unsigned)(now.tv_sec * 1000000 + now.tv_nsec / 1000);
+    }
+
+    static void SimpleMsDelay(unsigned _milliSeconds) { SimpleusDelay(_milliSeconds * 1000); }
+    static void SimpleusDelay(unsigned _microSeconds)
+    {
+        if (GetFake()->set) {
+            GetFake()->ticks += _microSeconds;
+        }
+    }
+
+    // host only
+    static void SetClockTicks(unsigned _ticks)
+    {
+        GetFake()->ticks = _ticks;
+        GetFake()->set = TRUE;
+    }
+    static void AdvanceClockTicks(unsigned _ticks) { SimpleusDelay(_ticks); }
+    static void UseRealClock(void) { GetFake()->set = FALSE; }
+
+private:
+    struct Fake
+    {
+        boolean set;
+        unsigned ticks;
+    };
+
+    static Fake *GetFake(void)
+    {
+        static Fake fake;
+        return &fake;
+    }
+};
+
+#endif // _circle_timer_h
@@ -0,0 +1,44 @@
+//
+// usertimer.h
+//
+// Host stand-in for the circle header of the same name
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _circle_usertimer_h
+#define _circle_usertimer_h
+
+#include <circle/interrupt.h>
+#include <circle/types.h>
+
+class CUserTimer;
+
+typedef void TUserTimerHandler(CUserTimer *_userTimer, void *_param);
+
+// never fires, WaitForInterrupt() returns at once on the host anyway
+class CUserTimer
+{
+public:
+    CUserTimer(CInterruptSystem *_interrupt, TUserTimerHandler *_handler, void *_param = 0,
+               boolean _useFIQ = FALSE)
+    {
+    }
+
+    boolean Initialize(void) { return TRUE; }
+    void Start(unsigned _delayMicros) {}
+    void Stop(void) {}
+};
+
+#endif // _circle_usertimer_h
@@ -0,0 +1,277 @@
+//
+// pixelconverttest.cpp
+//
+// Checks the pixel conversion kernels against the plain C build and a
+// reference formula, then times both builds
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// the Makefile builds lib/pixelconvert.cpp a second time without NEON and
+// with the class renamed, this declares that copy
+#define PixelConvert PixelConvertScalar
+#include <excircles/pixelconvert.h>
+#undef PixelConvert
+#undef _pixelconvert_h
+#include <excircles/pixelconvert.h>
+
+// one ILI9341 frame worth of pixels
+#define PIXELS          (240 * 320)
+#define ROUNDS          20
+// leaves the source and destination at every offset from a NEON block
+#define OFFSETS         8
+
+static u32 rgb888[PIXELS];
+static u16 foreground[PIXELS];
+static u16 background[PIXELS];
+static u16 out565[PIXELS];
+static u16 scalar565[PIXELS];
+static u8 out666[3 * PIXELS];
+static u8 scalar666[3 * PIXELS];
+
+static unsigned failures;
+
+// the formulas written out channel by channel, nothing shared with the
+// library
+
+static u16 RefRGB565(u32 _color)
+{
+    unsigned r = (_color >> 16) & 0xFF;
+    unsigned g = (_color >> 8) & 0xFF;
+    unsigned b = _color & 0xFF;
+    return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+}
+
+static void RefRGB666(u8 *_dst, u32 _color)
+{
+    _dst[0] = ((_color >> 16) & 0xFF) >> 2;
+    _dst[1] = ((_color >> 8) & 0xFF) >> 2;
+    _dst[2] = (_color & 0xFF) >> 2;
+}
+
+static unsigned RefChannel(int _fg, int _bg, unsigned _alpha)
+{
+    // rounds towards minus infinity like the kernels
+    return _bg + (((_fg - _bg) * (int)_alpha) >> 5);
+}
+
+static u16 RefBlend(u16 _fg, u16 _bg, unsigned _alpha)
+{
+    unsigned r = RefChannel(_fg >> 11, _bg >> 11, _alpha);
+    unsigned g = RefChannel((_fg >> 5) & 0x3F, (_bg >> 5) & 0x3F, _alpha);
+    unsigned b = RefChannel(_fg & 0x1F, _bg & 0x1F, _alpha);
+    return (r << 11) | (g << 5) | b;
+}
+
+static void Fail(const char *_kernel, unsigned _offset, unsigned _count, unsigned _index)
+{
+    if (failures++ < 10) {
+        printf("FAIL %s, offset %u, count %u: pixel %u\n", _kernel, _offset, _count, _index);
+    }
+}
+
+static void CheckRGB565(unsigned _offset, unsigned _count)
+{
+    memset(out565, 0, sizeof out565);
+    memset(scalar565, 0, sizeof scalar565);
+    PixelConvert::RGB888ToRGB565(out565 + _offset, rgb888 + _offset, _count);
+    PixelConvertScalar::RGB888ToRGB565(scalar565 + _offset, rgb888 + _offset, _count);
+
+    for (unsigned i = 0; i < _offset + _count + 1; i++) {
+        u16 expected = i >= _offset && i < _offset + _count ? RefRGB565(rgb888[i]) : 0;
+        if (out565[i] != expected || scalar565[i] != expected) {
+            Fail("RGB888ToRGB565", _offset, _count, i);
+            return;
+        }
+    }
+}
+
+static void CheckRGB666(unsigned _offset, unsigned _count)
+{
+    memset(out666, 0, sizeof out666);
+    memset(scalar666, 0, sizeof scalar666);
+    PixelConvert::RGB888ToRGB666(out666 + 3 * _offset, rgb888 + _offset, _count);
+    PixelConvertScalar::RGB888ToRGB666(scalar666 + 3 * _offset, rgb888 + _offset, _count);
+
+    for (unsigned i = 0; i < _offset + _count + 1; i++) {
+        u8 expected[3] = { 0, 0, 0 };
+        if (i >= _offset && i < _offset + _count) {
+            RefRGB666(expected, rgb888[i]);
+        }
+        if (memcmp(&out666[3 * i], expected, 3) != 0
+            || memcmp(&scalar666[3 * i], expected, 3) != 0) {
+            Fail("RGB888ToRGB666", _offset, _count, i);
+            return;
+        }
+    }
+}
+
+static void CheckSwap(unsigned _offset, unsigned _count)
+{
+    // in place, as the flush code uses it
+    memcpy(out565, foreground, sizeof out565);
+    memcpy(scalar565, foreground, sizeof scalar565);
+    PixelConvert::SwapRGB565(out565 + _offset, out565 + _offset, _count);
+    PixelConvertScalar::SwapRGB565(scalar565 + _offset, scalar565 + _offset, _count);
+
+    for (unsigned i = 0; i < _offset + _count + 1; i++) {
+        u16 pixel = foreground[i];
+        u16 expected = i >= _offset && i < _offset + _count ? (u16)((pixel >> 8) | (pixel << 8))
+                                                            : pixel;
+        if (out565[i] != expected || scalar565[i] != expected) {
+            Fail("SwapRGB565", _offset, _count, i);
+            return;
+        }
+    }
+}
+
+static void CheckBlend(unsigned _offset, unsigned _count, unsigned _alpha)
+{
+    memset(out565, 0, sizeof out565);
+    memset(scalar565, 0, sizeof scalar565);
+    PixelConvert::BlendRGB565(out565 + _offset, foreground + _offset, background + _offset,
+                              _alpha, _count);
+    PixelConvertScalar::BlendRGB565(scalar565 + _offset, foreground + _offset,
+                                    background + _offset, _alpha, _count);
+
+    for (unsigned i = 0; i < _offset + _count + 1; i++) {
+        u16 expected = i >= _offset && i < _offset + _count
+                       ? RefBlend(foreground[i], background[i], _alpha) : 0;
+        if (out565[i] != expected || scalar565[i] != expected) {
+            Fail("BlendRGB565", _offset, _count, i);
+            return;
+        }
+    }
+}
+
+static void CheckBlendChannels(void)
+{
+    // every pair of channel values at every alpha; gray pixels put the
+    // same value into red, green and blue
+    for (unsigned alpha = 0; alpha <= 32; alpha++) {
+        for (unsigned f = 0; f < 64; f++) {
+            for (unsigned b = 0; b < 64; b++) {
+                unsigned i = f * 64 + b;
+                foreground[i] = ((f >> 1) << 11) | (f << 5) | (f >> 1);
+                background[i] = ((b >> 1) << 11) | (b << 5) | (b >> 1);
+            }
+        }
+        CheckBlend(0, 64 * 64, alpha);
+    }
+}
+
+static double Now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e6 + now.tv_nsec / 1e3;
+}
+
+static void Report(const char *_name, double _us, double _scalarUs)
+{
+    double pixels = (double)PIXELS * ROUNDS;
+    printf("%-20s %8.0f us %7.1f pixels/us   C %8.0f us %7.1f pixels/us   x%.2f\n",
+           _name, _us, pixels / _us, _scalarUs, pixels / _scalarUs, _scalarUs / _us);
+}
+
+// _call gets the round, which some kernels take as a parameter
+template <class Call>
+static double Time(Call _call)
+{
+    double start = Now();
+    for (unsigned round = 0; round < ROUNDS; round++) {
+        _call(round);
+    }
+    return Now() - start;
+}
+
+static void Benchmark(void)
+{
+    double us = Time([](unsigned) {
+        PixelConvert::RGB888ToRGB565(out565, rgb888, PIXELS);
+    });
+    double scalarUs = Time([](unsigned) {
+        PixelConvertScalar::RGB888ToRGB565(scalar565, rgb888, PIXELS);
+    });
+    Report("RGB888 -> RGB565", us, scalarUs);
+
+    us = Time([](unsigned) {
+        PixelConvert::RGB888ToRGB666(out666, rgb888, PIXELS);
+    });
+    scalarUs = Time([](unsigned) {
+        PixelConvertScalar::RGB888ToRGB666(scalar666, rgb888, PIXELS);
+    });
+    Report("RGB888 -> RGB666", us, scalarUs);
+
+    us = Time([](unsigned) {
+        PixelConvert::SwapRGB565(out565, out565, PIXELS);
+    });
+    scalarUs = Time([](unsigned) {
+        PixelConvertScalar::SwapRGB565(scalar565, scalar565, PIXELS);
+    });
+    Report("RGB565 swap", us, scalarUs);
+
+    us = Time([](unsigned _round) {
+        PixelConvert::BlendRGB565(out565, foreground, background, _round, PIXELS);
+    });
+    scalarUs = Time([](unsigned _round) {
+        PixelConvertScalar::BlendRGB565(scalar565, foreground, background, _round, PIXELS);
+    });
+    Report("RGB565 blend", us, scalarUs);
+}
+
+int main(void)
+{
+    printf("pixel conversion kernels: %s, compared with %s\n",
+           PixelConvert::GetImplementation(), PixelConvertScalar::GetImplementation());
+
+    // pseudo random test pattern
+    u32 seed = 12345;
+    for (unsigned i = 0; i < PIXELS; i++) {
+        seed = seed * 1103515245 + 12345;
+        rgb888[i] = seed >> 8;
+        foreground[i] = seed >> 16;
+        background[i] = seed;
+    }
+
+    // short counts only run the tail loop, the longer ones both loops
+    static const unsigned counts[] = { 0, 1, 7, 8, 9, 15, 16, 17, 63, 1027 };
+    for (unsigned offset = 0; offset < OFFSETS; offset++) {
+        for (unsigned c = 0; c < sizeof counts / sizeof counts[0]; c++) {
+            CheckRGB565(offset, counts[c]);
+            CheckRGB666(offset, counts[c]);
+            CheckSwap(offset, counts[c]);
+            for (unsigned alpha = 0; alpha <= 32; alpha++) {
+                CheckBlend(offset, counts[c], alpha);
+            }
+        }
+    }
+    CheckBlendChannels();
+
+    if (failures > 0) {
+        printf("%u checks failed\n", failures);
+        return 1;
+    }
+    printf("all checks passed\n");
+
+    // the channel check overwrote part of the pattern, that does not
+    // matter for the timing
+    Benchmark();
+
+    return 0;
+}
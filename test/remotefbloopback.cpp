@@ -0,0 +1,140 @@
+//
+// remotefbloopback.cpp
+//
+// RemoteFramebuffer on the host, the receiver of tools/remotefb.py --loopback
+// Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Usage: remotefbloopback WIDTHxHEIGHT FILE
+//
+// Packets come in on stdin and the answers go out on stdout. After every
+// frame the display content is written to FILE as RGB565 pixels, little
+// endian, before the frame is acknowledged; the sender compares it with
+// what it sent.
+//
+#include <circle/device.h>
+#include <excircles/memorydisplay.h>
+#include <excircles/remotefb.h>
+#include <assert.h>
+#include <poll.h>
+#include <stdio.h>
+#include <unistd.h>
+
+// answers of one Update(), it reads at most 256 bytes, which are at most
+// 16 packets
+#define PIPE_OUTPUT_SIZE    1024
+
+// Stands in for the serial device. Reads wait a millisecond at most, like
+// a polled UART; writes are held back until Flush().
+class PipeDevice : public CDevice
+{
+public:
+    PipeDevice(void)
+        : closed(FALSE),
+          pending(0)
+    {
+    }
+
+    int Read(void *_buffer, size_t _count)
+    {
+        struct pollfd input = { 0, POLLIN, 0 };
+        if (poll(&input, 1, 1) <= 0) {
+            return 0;
+        }
+        ssize_t result = read(0, _buffer, _count);
+        if (result <= 0) {
+            closed = TRUE;
+            return 0;
+        }
+        return result;
+    }
+
+    int Write(const void *_buffer, size_t _count)
+    {
+        assert(pending + _count <= PIPE_OUTPUT_SIZE);
+        const u8 *data = (const u8 *)_buffer;
+        for (size_t i = 0; i < _count; i++) {
+            output[pending++] = data[i];
+        }
+        return _count;
+    }
+
+    void Flush(void)
+    {
+        if (pending > 0 && write(1, output, pending) != (ssize_t)pending) {
+            closed = TRUE;
+        }
+        pending = 0;
+    }
+
+    boolean IsClosed(void) const { return closed; }
+
+private:
+    boolean closed;
+    u8 output[PIPE_OUTPUT_SIZE];
+    unsigned pending;
+};
+
+static boolean Dump(const MemoryDisplayDevice *_display, const char *_path)
+{
+    FILE *file = fopen(_path, "wb");
+    if (file == 0) {
+        return FALSE;
+    }
+    for (unsigned y = 0; y < _display->GetHeight(); y++) {
+        for (unsigned x = 0; x < _display->GetWidth(); x++) {
+            u16 pixel = _display->GetPixel(x, y);
+            fputc(pixel & 0xFF, file);
+            fputc(pixel >> 8, file);
+        }
+    }
+    return fclose(file) == 0;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned width;
+    unsigned height;
+    if (argc != 3 || sscanf(argv[1], "%ux%u", &width, &height) != 2
+        || width == 0 || height == 0) {
+        fprintf(stderr, "usage: %s WIDTHxHEIGHT FILE\n", argv[0]);
+        return 2;
+    }
+
+    PipeDevice pipe;
+    MemoryDisplayDevice display(width, height);
+    RemoteFramebuffer remote(&pipe, &display);
+    if (! display.Initialize() || ! remote.Initialize()) {
+        return 1;
+    }
+
+    unsigned frames = 0;
+    while (! pipe.IsClosed()) {
+        remote.Update();
+        if (remote.GetFrames() != frames) {
+            frames = remote.GetFrames();
+            if (! Dump(&display, argv[2])) {
+                fprintf(stderr, "%s: cannot write %s\n", argv[0], argv[2]);
+                return 1;
+            }
+        }
+        pipe.Flush();
+    }
+
+    fprintf(stderr, "receiver: %u frames, %u packets, %u bad packets\n",
+            remote.GetFrames(), remote.GetPackets(), remote.GetErrors());
+
+    return 0;
+}
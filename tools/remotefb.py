@@ -0,0 +1,334 @@
+#!/usr/bin/env python3
+#
+# remotefb.py
+#
+# Send images to a display driven by RemoteFramebuffer
+# (include/excircles/remotefb.h) over a serial line.
+# Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Usage: remotefb.py [--port /dev/ttyUSB0] [--baud 921600] [--interval S]
+#                    [--repeat] [image.ppm ...]
+#        remotefb.py --loopback [--receiver PATH] [--size 240x320] [--corrupt P]
+#                    [image.ppm ...]
+#
+# Without images a moving test pattern is sent. Only the part of a frame
+# that changed goes out, packet by packet in the smallest of the RAW, RLE
+# and DELTA encodings. The serial port needs pyserial.
+#
+# --loopback runs the receiver code of the board, lib/remotefb.cpp, on the
+# host instead (build it with "make -C test") and checks every frame
+# against what was sent; --corrupt damages that share of the packets on
+# the way to exercise the retransmits.
+#
+
+import argparse
+import binascii
+import os
+import random
+import select
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+
+from rle565 import encode_row, read_ppm, rgb565
+
+MAX_PAYLOAD = 4096
+
+RAW = 0
+RLE = 1
+DELTA = 2
+FRAME = 3
+INFO = 4
+
+REPLY = 0x16
+ACK = 0x06
+NAK = 0x15
+REPLY_INFO = ord('I')
+
+DELTA_MAX_RUN = 64
+TIMEOUT = 0.5
+RETRIES = 8
+
+
+def crc16(data):
+    # CRC-16/XMODEM, as computed by the receiver
+    return binascii.crc_hqx(bytes(data), 0)
+
+
+def make_packet(kind, seq, x=0, y=0, width=0, height=0, payload=b''):
+    body = struct.pack('<BBHHHHH', kind, seq, x, y, width, height, len(payload)) + payload
+    return b'RF' + body + struct.pack('<H', crc16(body))
+
+
+def encode_raw_row(row):
+    return struct.pack('<%dH' % len(row), *row)
+
+
+def encode_delta_row(row, old):
+    out = bytearray()
+    i = 0
+    while i < len(row):
+        n = 0
+        while i + n < len(row) and row[i + n] == old[i + n] and n < DELTA_MAX_RUN:
+            n += 1
+        if n > 0:
+            out.append(0x80 | (n - 1))
+            i += n
+            continue
+        # changed pixels up to the next unchanged one
+        end = i
+        while end < len(row) and row[end] != old[end]:
+            end += 1
+        while i < end:
+            color = row[i]
+            n = 1
+            while i + n < end and row[i + n] == color and n < DELTA_MAX_RUN:
+                n += 1
+            if n >= 3:
+                out.append(0x40 | (n - 1))
+                out.extend(struct.pack('<H', color))
+            else:
+                # literal pixels up to where a repeat run starts
+                n = 1
+                while i + n < end and n < DELTA_MAX_RUN and \
+                        row[i + n:i + n + 3] != [row[i + n]] * 3:
+                    n += 1
+                out.append(n - 1)
+                out.extend(struct.pack('<%dH' % n, *row[i:i + n]))
+            i += n
+    return out
+
+
+def dirty_rect(frame, old, width, height):
+    if old is None:
+        return 0, 0, width, height
+    rows = [y for y in range(height)
+            if frame[y * width:(y + 1) * width] != old[y * width:(y + 1) * width]]
+    if not rows:
+        return None
+    x0, x1 = width, -1
+    for y in rows:
+        for x in range(width):
+            if frame[y * width + x] != old[y * width + x]:
+                x0 = min(x0, x)
+                x1 = max(x1, x)
+                break
+        for x in range(width - 1, x0 - 1, -1):
+            if frame[y * width + x] != old[y * width + x]:
+                x1 = max(x1, x)
+                break
+    return x0, rows[0], x1 - x0 + 1, rows[-1] - rows[0] + 1
+
+
+def encode_frame(frame, old, width, height):
+    # yields (kind, x, y, w, h, payload) for the part that changed, in
+    # strips of whole rows that fit a packet
+    rect = dirty_rect(frame, old, width, height)
+    if rect is None:
+        return
+    x, y, w, h = rect
+    kinds = [RAW, RLE] + ([DELTA] if old is not None else [])
+    strip = {kind: bytearray() for kind in kinds}
+    top = y
+    for row_y in range(y, y + h):
+        row = frame[row_y * width + x:row_y * width + x + w]
+        rows = {RAW: encode_raw_row(row), RLE: encode_row(row, None)}
+        if old is not None:
+            rows[DELTA] = encode_delta_row(row, old[row_y * width + x:row_y * width + x + w])
+        if row_y > top and all(len(strip[k]) + len(rows[k]) > MAX_PAYLOAD for k in kinds):
+            best = min(kinds, key=lambda k: len(strip[k]))
+            yield best, x, top, w, row_y - top, bytes(strip[best])
+            strip = {kind: bytearray() for kind in kinds}
+            top = row_y
+        for kind in kinds:
+            strip[kind].extend(rows[kind])
+    # a strip longer than a packet can only use the encodings that fit
+    fitting = [k for k in kinds if len(strip[k]) <= MAX_PAYLOAD]
+    best = min(fitting, key=lambda k: len(strip[k]))
+    yield best, x, top, w, y + h - top, bytes(strip[best])
+
+
+class LoopbackLink:
+    # looks like a serial port with lib/remotefb.cpp on the other end, run
+    # on the host by test/remotefbloopback
+
+    def __init__(self, receiver, width, height, corrupt):
+        self.dump = tempfile.NamedTemporaryFile(prefix='remotefb', suffix='.raw')
+        self.process = subprocess.Popen([receiver, '%dx%d' % (width, height), self.dump.name],
+                                        stdin=subprocess.PIPE, stdout=subprocess.PIPE)
+        self.corrupt = corrupt
+
+    def write(self, data):
+        data = bytearray(data)
+        if random.random() < self.corrupt:
+            data[random.randrange(len(data))] ^= 0xFF
+        self.process.stdin.write(data)
+        self.process.stdin.flush()
+
+    def read(self, size=1):
+        # returns what came within 50 ms, like the serial port
+        ready, _, _ = select.select([self.process.stdout], [], [], 0.05)
+        if not ready:
+            return b''
+        return os.read(self.process.stdout.fileno(), size)
+
+    def pixels(self):
+        # the receiver writes its display to the file before it answers FRAME
+        data = open(self.dump.name, 'rb').read()
+        return list(struct.unpack('<%dH' % (len(data) // 2), data))
+
+    def close(self):
+        self.process.stdin.close()
+        status = self.process.wait()
+        self.dump.close()
+        return status
+
+
+class Sender:
+
+    def __init__(self, link):
+        self.link = link
+        self.seq = 0
+        self.sent = 0
+        self.retries = 0
+
+    def wait_reply(self, seq):
+        deadline = time.monotonic() + TIMEOUT
+        log = bytearray()
+        while time.monotonic() < deadline:
+            byte = self.link.read(1)
+            if not byte:
+                continue
+            if byte[0] != REPLY:
+                # kernel log output shares the line
+                log.extend(byte)
+                if byte == b'\n':
+                    sys.stdout.write(log.decode('ascii', 'replace'))
+                    log.clear()
+                continue
+            status = self.link.read(1)
+            if not status or self.link.read(1) != bytes([seq]):
+                continue
+            if status[0] == REPLY_INFO:
+                return struct.unpack('<HHH', self.link.read(6))
+            return status[0]
+        return None
+
+    def send(self, kind, *args):
+        self.seq = (self.seq + 1) & 0xFF
+        packet = make_packet(kind, self.seq, *args)
+        for attempt in range(RETRIES):
+            self.link.write(packet)
+            reply = self.wait_reply(self.seq)
+            if reply is not None and reply != NAK:
+                self.sent += len(packet)
+                return reply
+            self.retries += 1
+        sys.exit('no answer from the receiver')
+
+    def send_frame(self, frame, old, width, height):
+        for kind, x, y, w, h, payload in encode_frame(frame, old, width, height):
+            self.send(kind, x, y, w, h, payload)
+        self.send(FRAME)
+
+
+def test_pattern(width, height, count):
+    # a bar moving over a gradient, only the bar changes between frames
+    background = [rgb565(x * 255 // width, y * 255 // height, 96)
+                  for y in range(height) for x in range(width)]
+    for i in range(count):
+        frame = list(background)
+        top = (i * 8) % (height - 16)
+        for y in range(top, top + 16):
+            for x in range(width // 4, 3 * width // 4):
+                frame[y * width + x] = 0xFFFF
+        yield frame
+
+
+def load_images(paths, width, height):
+    for path in paths:
+        w, h, pixels = read_ppm(path)
+        if (w, h) != (width, height):
+            sys.exit('%s: %d x %d does not match the display, %d x %d' % (path, w, h,
+                                                                      width, height))
+        yield pixels
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Send images to a RemoteFramebuffer display')
+    parser.add_argument('--port', default='/dev/ttyUSB0', help='serial port')
+    parser.add_argument('--baud', type=int, default=921600, help='baud rate')
+    parser.add_argument('--interval', type=float, default=0, help='seconds between images')
+    parser.add_argument('--repeat', action='store_true', help='send the images over and over')
+    parser.add_argument('--frames', type=int, default=60, help='test pattern frames')
+    parser.add_argument('--loopback', action='store_true', help='receiver on the host')
+    parser.add_argument('--receiver', default=os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                                                           '..', 'test', 'remotefbloopback'),
+                        help='loopback receiver program')
+    parser.add_argument('--size', default='240x320', help='loopback display size')
+    parser.add_argument('--corrupt', type=float, default=0,
+                        help='share of loopback packets to damage')
+    parser.add_argument('images', nargs='*')
+    args = parser.parse_args()
+
+    loopback = None
+    if args.loopback:
+        if not os.access(args.receiver, os.X_OK):
+            sys.exit('%s not found, build it with "make -C test"' % args.receiver)
+        width, height = (int(v) for v in args.size.split('x'))
+        link = loopback = LoopbackLink(args.receiver, width, height, args.corrupt)
+    else:
+        import serial
+        link = serial.Serial(args.port, args.baud, timeout=0.05)
+
+    sender = Sender(link)
+    width, height, max_payload = sender.send(INFO)
+    if max_payload < MAX_PAYLOAD:
+        sys.exit('receiver takes %d byte payloads, %d needed' % (max_payload, MAX_PAYLOAD))
+    print('display %d x %d' % (width, height))
+
+    start = time.monotonic()
+    old = None
+    frames = 0
+    while True:
+        if args.images:
+            source = load_images(args.images, width, height)
+        else:
+            source = test_pattern(width, height, args.frames)
+        for frame in source:
+            sender.send_frame(frame, old, width, height)
+            if loopback is not None and loopback.pixels() != frame:
+                sys.exit('frame %d differs after decoding' % frames)
+            old = frame
+            frames += 1
+            time.sleep(args.interval)
+        if not args.repeat:
+            break
+
+    elapsed = time.monotonic() - start
+    raw = frames * width * height * 2
+    print('%d frames, %d bytes sent for %d raw bytes (%.1f%%), %d retries, %.1f s' %
+          (frames, sender.sent, raw, 100.0 * sender.sent / raw, sender.retries, elapsed))
+    if loopback is not None:
+        if loopback.close() != 0:
+            sys.exit('the loopback receiver failed')
+        print('loopback: all frames matched')
+
+
+if __name__ == '__main__':
+    main()
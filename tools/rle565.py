@@ -0,0 +1,166 @@
+#!/usr/bin/env python3
+#
+# rle565.py
+#
+# Convert a binary PPM (P6) image into the run-length encoded RGB565
+# format drawn by RLEBitmap (include/excircles/rlebitmap.h).
+# Copyright (C) 2020  H. Kocevar <hinxx@protonmail.com>
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Usage: rle565.py [--key RRGGBB] [--name NAME] input.ppm output.h
+#
+# Any image editor can export PPM; with ImageMagick use
+#   convert icon.png icon.ppm
+#
+
+import argparse
+import struct
+import sys
+
+RLE_FLAG_TRANSPARENT = 0x01
+MAX_RUN = 128
+
+
+def read_token(data, pos):
+    # skip whitespace and comments
+    while True:
+        while data[pos:pos + 1].isspace():
+            pos += 1
+        if data[pos:pos + 1] == b'#':
+            while data[pos:pos + 1] not in (b'\n', b''):
+                pos += 1
+        else:
+            break
+    start = pos
+    while not data[pos:pos + 1].isspace():
+        pos += 1
+    return data[start:pos], pos
+
+
+def read_ppm(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+    magic, pos = read_token(data, 0)
+    if magic != b'P6':
+        sys.exit('%s: only binary PPM (P6) images are supported' % path)
+    width, pos = read_token(data, pos)
+    height, pos = read_token(data, pos)
+    maxval, pos = read_token(data, pos)
+    width, height, maxval = int(width), int(height), int(maxval)
+    if maxval != 255:
+        sys.exit('%s: only 8 bit per channel images are supported' % path)
+    pos += 1
+    pixels = []
+    for i in range(width * height):
+        r, g, b = data[pos + 3 * i:pos + 3 * i + 3]
+        pixels.append(rgb565(r, g, b))
+    return width, height, pixels
+
+
+def rgb565(r, g, b):
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3)
+
+
+def encode_row(row, key):
+    out = bytearray()
+    literal = []
+
+    def flush_literal():
+        while literal:
+            chunk = literal[:MAX_RUN]
+            del literal[:MAX_RUN]
+            out.append(len(chunk) - 1)
+            for color in chunk:
+                out.extend(struct.pack('<H', color))
+
+    i = 0
+    while i < len(row):
+        color = row[i]
+        n = 1
+        while i + n < len(row) and row[i + n] == color and n < MAX_RUN:
+            n += 1
+        # key colored pixels always go into a repeat run so the decoder
+        # can skip them; other runs only pay off from 3 pixels on
+        if n >= 3 or color == key:
+            flush_literal()
+            out.append(0x80 | (n - 1))
+            out.extend(struct.pack('<H', color))
+        else:
+            literal.extend(row[i:i + n])
+        i += n
+    flush_literal()
+    return out
+
+
+def encode(width, height, pixels, key):
+    flags = RLE_FLAG_TRANSPARENT if key is not None else 0
+    out = bytearray(b'R5')
+    out.extend(struct.pack('<HHBBH', width, height, flags, 0, key or 0))
+    for y in range(height):
+        out.extend(encode_row(pixels[y * width:(y + 1) * width], key))
+    return out
+
+
+def decode(data):
+    width, height, flags, _, key = struct.unpack('<HHBBH', data[2:10])
+    pixels = []
+    pos = 10
+    while pos < len(data):
+        control = data[pos]
+        count = (control & 0x7F) + 1
+        pos += 1
+        if control & 0x80:
+            pixels.extend(struct.unpack('<H', data[pos:pos + 2]) * count)
+            pos += 2
+        else:
+            pixels.extend(struct.unpack('<%dH' % count, data[pos:pos + 2 * count]))
+            pos += 2 * count
+    return width, height, pixels
+
+
+def write_header(path, name, data, width, height):
+    with open(path, 'w') as f:
+        f.write('// generated by rle565.py, %d x %d pixels\n' % (width, height))
+        f.write('static const u8 %s[%d] = {\n' % (name, len(data)))
+        for i in range(0, len(data), 12):
+            f.write('    ' + ', '.join('0x%02X' % b for b in data[i:i + 12]) + ',\n')
+        f.write('};\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Convert a PPM image to RLE RGB565')
+    parser.add_argument('--key', help='transparent color as RRGGBB')
+    parser.add_argument('--name', default='bitmap', help='C array name')
+    parser.add_argument('input')
+    parser.add_argument('output')
+    args = parser.parse_args()
+
+    width, height, pixels = read_ppm(args.input)
+    key = None
+    if args.key:
+        value = int(args.key, 16)
+        key = rgb565(value >> 16, (value >> 8) & 0xFF, value & 0xFF)
+
+    data = encode(width, height, pixels, key)
+    # round trip to make sure the decoder sees what we meant
+    assert decode(data) == (width, height, pixels)
+
+    write_header(args.output, args.name, data, width, height)
+    print('%s: %d x %d, %d -> %d bytes' % (args.input, width, height,
+                                           2 * width * height, len(data)))
+
+
+if __name__ == '__main__':
+    main()